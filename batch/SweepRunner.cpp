@@ -0,0 +1,290 @@
+#include "SweepRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#ifdef CRYSTALGROWTH_TELEMETRY
+#include "TelemetryPublisher.h"
+#endif
+
+using namespace std;
+
+SweepRunner::SweepRunner(const SweepSpec& spec, const string& outputPath, int threadCount)
+	:_spec(spec), _outputPath(outputPath), _threadCount(max(1, threadCount))
+{
+}
+
+void SweepRunner::setTelemetry(const string& name, int interval, int downsample)
+{
+	_telemetryName = name;
+	_telemetryInterval = interval;
+	_telemetryDownsample = downsample;
+}
+
+int SweepRunner::getThreadsPerRun(GridSize size, int threadCount)
+{
+	const long long cellsPerThread = 512 * 512;
+	long long cells = static_cast<long long>(size.x) * static_cast<long long>(size.y);
+
+	long long threads = cells / cellsPerThread;
+	return static_cast<int>(max(1LL, min(threads, static_cast<long long>(threadCount))));
+}
+
+bool SweepRunner::run()
+{
+	if (!_openOutput())
+		return false;
+
+	vector<SweepRun> runs = generateSweepRuns(_spec);
+	vector<SweepRun> pending;
+	for (auto& run : runs)
+	{
+		if (_completed.count(run.id) == 0)
+			pending.push_back(run);
+	}
+
+	int threadsPerRun = getThreadsPerRun(_spec.size, _threadCount);
+	int workerCount = max(1, _threadCount / threadsPerRun);
+	fprintf(stderr, "%zu runs, %zu done, %d workers x %d threads\n",
+		runs.size(), runs.size() - pending.size(), workerCount, threadsPerRun);
+
+	// Contiguous blocks per worker, so a thief takes work from the far end of a victim's block.
+	WorkStealingQueue<SweepRun> queue(workerCount);
+	for (size_t k = 0; k < pending.size(); k++)
+	{
+		queue.push(static_cast<int>(k * workerCount / pending.size()), pending[k]);
+	}
+
+	vector<thread> workers;
+	for (int w = 0; w < workerCount; w++)
+	{
+		workers.emplace_back(&SweepRunner::_worker, this, ref(queue), w, threadsPerRun);
+	}
+	for (auto& w : workers)
+	{
+		w.join();
+	}
+
+	fclose(_output);
+	_output = nullptr;
+	if (_morphology != nullptr)
+	{
+		fclose(_morphology);
+		_morphology = nullptr;
+	}
+	return true;
+}
+
+// Reads the run id in front of the first comma. False if it is not a number.
+static bool _parseId(const string& line, int& id)
+{
+	char* end = nullptr;
+	long value = strtol(line.c_str(), &end, 10);
+	if (end == line.c_str() || *end != ',')
+		return false;
+	id = static_cast<int>(value);
+	return true;
+}
+
+bool SweepRunner::_openOutput()
+{
+	const size_t fieldCount = static_cast<size_t>(KobayashiSolver::PARAM::COUNT) + 10;
+
+	// Keep the complete records of a previous attempt. A record cut off by an
+	// interruption has no newline or too few fields and is dropped.
+	vector<string> records;
+	ifstream in(_outputPath);
+	if (in)
+	{
+		string line;
+		if (!getline(in, line) || line != "# " + _spec.describe())
+		{
+			fprintf(stderr, "%s belongs to a different sweep\n", _outputPath.c_str());
+			return false;
+		}
+		getline(in, line); // column names
+
+		while (getline(in, line))
+		{
+			if (in.eof())
+				break;
+			int id;
+			if (static_cast<size_t>(count(line.begin(), line.end(), ',')) + 1 != fieldCount
+				|| !_parseId(line, id))
+				continue;
+
+			if (_completed.insert(id).second)
+				records.push_back(line);
+		}
+		in.close();
+	}
+
+	if (!_rewriteFile(_outputPath, _header(), records, _output))
+		return false;
+
+	if (_spec.morphologyInterval <= 0)
+		return true;
+
+	// Morphology series are written before their run record, so only the series of
+	// completed runs are kept.
+	const size_t morphologyFieldCount = 8;
+	vector<string> series;
+	ifstream morphologyIn(_morphologyPath());
+	if (morphologyIn)
+	{
+		string line;
+		getline(morphologyIn, line);
+		getline(morphologyIn, line);
+
+		while (getline(morphologyIn, line))
+		{
+			if (morphologyIn.eof())
+				break;
+			int id;
+			if (static_cast<size_t>(count(line.begin(), line.end(), ',')) + 1 != morphologyFieldCount
+				|| !_parseId(line, id))
+				continue;
+			if (_completed.count(id) > 0)
+				series.push_back(line);
+		}
+		morphologyIn.close();
+	}
+
+	ostringstream header;
+	header << "# " << _spec.describe() << "\nid,";
+	MorphologyAnalyzer::writeHeader(header);
+
+	return _rewriteFile(_morphologyPath(), header.str(), series, _morphology);
+}
+
+// Rewrites through a temporary file so the kept lines survive another interruption,
+// then opens the file for appending. rename() replaces the file atomically on POSIX;
+// Windows cannot rename onto an existing file, so the old one is removed first there.
+bool SweepRunner::_rewriteFile(const string& path, const string& header, const vector<string>& lines, FILE*& file)
+{
+	string tmpPath = path + ".tmp";
+	FILE* tmp = fopen(tmpPath.c_str(), "w");
+	if (tmp == nullptr)
+	{
+		fprintf(stderr, "cannot open %s\n", tmpPath.c_str());
+		return false;
+	}
+
+	fprintf(tmp, "%s", header.c_str());
+	for (auto& line : lines)
+	{
+		fprintf(tmp, "%s\n", line.c_str());
+	}
+	if (fclose(tmp) != 0)
+	{
+		fprintf(stderr, "cannot write %s\n", tmpPath.c_str());
+		return false;
+	}
+
+#ifdef _WIN32
+	remove(path.c_str());
+#endif
+	if (rename(tmpPath.c_str(), path.c_str()) != 0
+		|| (file = fopen(path.c_str(), "a")) == nullptr)
+	{
+		fprintf(stderr, "cannot open %s\n", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+string SweepRunner::_morphologyPath() const
+{
+	return _outputPath + ".morphology.csv";
+}
+
+string SweepRunner::_header() const
+{
+	string header = "# " + _spec.describe() + "\nid";
+	for (int i = 0; i < static_cast<int>(KobayashiSolver::PARAM::COUNT); i++)
+	{
+		header += string(",") + getParameterName(static_cast<KobayashiSolver::PARAM>(i));
+	}
+	header += ",steps,stop_reason,seconds,solid_fraction,min_x,min_y,max_x,max_y,max_delta_phi\n";
+	return header;
+}
+
+void SweepRunner::_worker(WorkStealingQueue<SweepRun>& queue, int worker, int threadsPerRun)
+{
+	TelemetryPublisher* telemetry = nullptr;
+#ifdef CRYSTALGROWTH_TELEMETRY
+	if (!_telemetryName.empty())
+		telemetry = new TelemetryPublisher(_telemetryName + "-" + to_string(worker),
+			_spec.size, _telemetryDownsample, _telemetryInterval);
+#endif
+
+	SweepRun run;
+	while (queue.pop(worker, run))
+	{
+		_runOne(run, threadsPerRun, telemetry);
+	}
+
+#ifdef CRYSTALGROWTH_TELEMETRY
+	delete telemetry;
+#endif
+}
+
+void SweepRunner::_runOne(const SweepRun& run, int threadsPerRun, TelemetryPublisher* telemetry)
+{
+	KobayashiSolver solver(_spec.size.x, _spec.size.y, _spec.timeStep);
+	for (int i = 0; i < static_cast<int>(KobayashiSolver::PARAM::COUNT); i++)
+	{
+		solver.setParameter(static_cast<KobayashiSolver::PARAM>(i), run.param[i]);
+	}
+	solver.setThreadCount(threadsPerRun);
+	solver.setStopCondition(_spec.stopCondition);
+	solver.setNoise(_spec.noiseAmplitude, _spec.noiseSeed);
+
+	MorphologyAnalyzer morphology(solver, max(1, _spec.morphologyInterval));
+
+	auto startTime = chrono::steady_clock::now();
+	for (int s = 0; s < _spec.steps && !solver.isStopped(); s++)
+	{
+		solver.step();
+		if (_spec.morphologyInterval > 0)
+			morphology.update();
+#ifdef CRYSTALGROWTH_TELEMETRY
+		if (telemetry != nullptr)
+			telemetry->update(solver);
+#endif
+	}
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+	const StepStatistics& statistics = solver.getStatistics();
+	const char* stopReason = solver.isStopped() ? KobayashiSolver::getStopReasonName(solver.getStopReason()) : "steps";
+
+	string record = to_string(run.id);
+	char value[128];
+	for (int i = 0; i < static_cast<int>(KobayashiSolver::PARAM::COUNT); i++)
+	{
+		snprintf(value, sizeof(value), ",%.9g", run.param[i]);
+		record += value;
+	}
+	snprintf(value, sizeof(value), ",%lld,%s,%.3f,%.6f,%d,%d,%d,%d,%.6g",
+		solver.getStepCount(), stopReason, elapsed.count(), statistics.solidFraction,
+		statistics.minX, statistics.minY, statistics.maxX, statistics.maxY, statistics.maxDeltaPhi);
+	record += value;
+
+	ostringstream series;
+	for (auto& sample : morphology.getSamples())
+	{
+		series << run.id << ',';
+		MorphologyAnalyzer::writeSample(series, sample);
+	}
+
+	lock_guard<mutex> lock(_outputMutex);
+	if (_morphology != nullptr)
+	{
+		fprintf(_morphology, "%s", series.str().c_str());
+		fflush(_morphology);
+	}
+	fprintf(_output, "%s\n", record.c_str());
+	fflush(_output);
+}
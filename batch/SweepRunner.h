@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+#include "MorphologyAnalyzer.h"
+#include "SweepSpec.h"
+#include "WorkStealingQueue.h"
+
+class TelemetryPublisher;
+
+// Runs a sweep on all cores and appends one CSV record per finished run to the output file.
+// If the file already holds records of the same sweep, those runs are skipped, so an
+// interrupted sweep is resumed by starting it again with the same arguments.
+// With a morphology interval, the time series of each run go to <output>.morphology.csv.
+// With telemetry, each worker publishes its current run to the channel <name>-<worker>.
+class SweepRunner
+{
+public:
+	SweepRunner(const SweepSpec& spec, const std::string& outputPath, int threadCount);
+
+	void setTelemetry(const std::string& name, int interval, int downsample);
+
+	// Returns false if the output file belongs to a different sweep or cannot be written.
+	bool run();
+
+	// Small grids run one per core; larger grids get enough threads per run to keep
+	// every band a few hundred thousand cells.
+	static int getThreadsPerRun(GridSize size, int threadCount);
+
+private:
+	SweepSpec _spec;
+	std::string _outputPath;
+	int _threadCount;
+
+	std::string _telemetryName;
+	int _telemetryInterval = 10;
+	int _telemetryDownsample = 1;
+
+	std::set<int> _completed;
+	FILE* _output = nullptr;
+	FILE* _morphology = nullptr;
+	std::mutex _outputMutex;
+
+	bool _openOutput();
+	static bool _rewriteFile(const std::string& path, const std::string& header, const std::vector<std::string>& lines, FILE*& file);
+	std::string _morphologyPath() const;
+	void _worker(WorkStealingQueue<SweepRun>& queue, int worker, int threadsPerRun);
+	void _runOne(const SweepRun& run, int threadsPerRun, TelemetryPublisher* telemetry);
+	std::string _header() const;
+};
@@ -0,0 +1,193 @@
+#include "SweepSpec.h"
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+
+using namespace std;
+
+static const char* PARAMETER_NAME[] = {
+	"tau", "epsilon_bar", "mu",
+	"K", "delta", "anisotropy",
+	"alpha", "gamma", "t_eq",
+};
+
+const char* getParameterName(KobayashiSolver::PARAM param)
+{
+	return PARAMETER_NAME[static_cast<int>(param)];
+}
+
+bool findParameter(const string& name, KobayashiSolver::PARAM& param)
+{
+	for (int i = 0; i < static_cast<int>(KobayashiSolver::PARAM::COUNT); i++)
+	{
+		if (name == PARAMETER_NAME[i])
+		{
+			param = static_cast<KobayashiSolver::PARAM>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+string SweepSpec::describe() const
+{
+	ostringstream out;
+	out << (mode == MODE::GRID ? "grid" : "lhs")
+		<< " size=" << size.x << "x" << size.y
+		<< " dt=" << timeStep
+		<< " steps=" << steps;
+	if (mode == MODE::LATIN_HYPERCUBE)
+		out << " samples=" << samples << " seed=" << seed;
+	if (stopCondition.boundaryMargin >= 0)
+		out << " stop-boundary=" << stopCondition.boundaryMargin;
+	if (stopCondition.solidFraction > 0.0f)
+		out << " stop-solid=" << stopCondition.solidFraction;
+	if (stopCondition.steadyDeltaPhi > 0.0f)
+		out << " stop-steady=" << stopCondition.steadyDeltaPhi;
+	if (stopCondition.wallClockSeconds > 0.0)
+		out << " stop-seconds=" << stopCondition.wallClockSeconds;
+	if (noiseAmplitude != 0.0f)
+		out << " noise=" << noiseAmplitude << " noise-seed=" << noiseSeed;
+	if (morphologyInterval > 0)
+		out << " morphology=" << morphologyInterval;
+	out << " vary=";
+	for (size_t i = 0; i < params.size(); i++)
+	{
+		out << (i == 0 ? "" : ",") << getParameterName(params[i]);
+	}
+	return out.str();
+}
+
+
+// xorshift64* is used instead of <random> so the samples do not depend on the standard library.
+struct SweepRandom
+{
+	explicit SweepRandom(unsigned int seed)
+		:state(0x9E3779B97F4A7C15ull ^ seed) {}
+
+	uint64_t next()
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1Dull;
+	}
+
+	// [0, 1)
+	float uniform()
+	{
+		return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f);
+	}
+
+	uint64_t state;
+};
+
+static void _gridRuns(const SweepSpec& spec, KobayashiSolver& reference, SweepRun base, vector<SweepRun>& runs)
+{
+	// Scroll positions of each varied parameter, enumerated in mixed radix.
+	vector<vector<float>> values;
+	for (auto param : spec.params)
+	{
+		const CrystalParameter& crystalParameter = reference.getCrystalParameter(param);
+
+		vector<float> value;
+		for (int pos = crystalParameter.param_i.minVal; pos <= crystalParameter.param_i.maxVal; pos += crystalParameter.param_i.stride)
+		{
+			value.push_back(static_cast<float>(pos) * crystalParameter.ratio);
+		}
+		values.push_back(value);
+	}
+
+	vector<size_t> digit(values.size(), 0);
+	while (true)
+	{
+		SweepRun run = base;
+		run.id = static_cast<int>(runs.size());
+		for (size_t k = 0; k < values.size(); k++)
+		{
+			run.param[static_cast<int>(spec.params[k])] = values[k][digit[k]];
+		}
+		runs.push_back(run);
+
+		size_t k = 0;
+		for (; k < digit.size(); k++)
+		{
+			if (++digit[k] < values[k].size())
+				break;
+			digit[k] = 0;
+		}
+		if (k == digit.size())
+			break;
+	}
+}
+
+static void _latinHypercubeRuns(const SweepSpec& spec, KobayashiSolver& reference, SweepRun base, vector<SweepRun>& runs)
+{
+	SweepRandom random(spec.seed);
+	int n = spec.samples;
+
+	runs.assign(n, base);
+	for (int s = 0; s < n; s++)
+	{
+		runs[s].id = s;
+	}
+
+	for (auto param : spec.params)
+	{
+		const CrystalParameter& crystalParameter = reference.getCrystalParameter(param);
+		float minVal = crystalParameter.param_f.minVal;
+		float maxVal = crystalParameter.param_f.maxVal;
+
+		// The anisotropy is the fold count j of cos(j * angl); a fractional j makes epsilon jump
+		// where angl wraps, so it is drawn from the scroll positions like the grid does.
+		bool discrete = (param == KobayashiSolver::PARAM::ANISOTROPY);
+		const ScrollParameter<int, int>& position = crystalParameter.param_i;
+		int positionCount = (position.maxVal - position.minVal) / position.stride + 1;
+
+		// Fisher-Yates shuffle of the strata
+		vector<int> stratum(n);
+		for (int s = 0; s < n; s++)
+		{
+			stratum[s] = s;
+		}
+		for (int s = n - 1; s > 0; s--)
+		{
+			swap(stratum[s], stratum[random.next() % static_cast<uint64_t>(s + 1)]);
+		}
+
+		for (int s = 0; s < n; s++)
+		{
+			float u = (static_cast<float>(stratum[s]) + random.uniform()) / static_cast<float>(n);
+			if (discrete)
+			{
+				int pos = min(static_cast<int>(u * static_cast<float>(positionCount)), positionCount - 1);
+				runs[s].param[static_cast<int>(param)] = static_cast<float>(position.minVal + pos * position.stride) * crystalParameter.ratio;
+			}
+			else
+			{
+				runs[s].param[static_cast<int>(param)] = minVal + u * (maxVal - minVal);
+			}
+		}
+	}
+}
+
+vector<SweepRun> generateSweepRuns(const SweepSpec& spec)
+{
+	// The ranges and defaults live in the solver's parameter table.
+	KobayashiSolver reference(3, 3, spec.timeStep);
+
+	SweepRun base;
+	base.id = 0;
+	for (int i = 0; i < static_cast<int>(KobayashiSolver::PARAM::COUNT); i++)
+	{
+		base.param[i] = reference.getParameter(static_cast<KobayashiSolver::PARAM>(i));
+	}
+
+	vector<SweepRun> runs;
+	if (spec.mode == SweepSpec::MODE::GRID)
+		_gridRuns(spec, reference, base, runs);
+	else
+		_latinHypercubeRuns(spec, reference, base, runs);
+
+	return runs;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "KobayashiSolver.h"
+
+// A parameter sweep over the ScrollParameter ranges of KobayashiSolver.
+// GRID walks every scroll position of the varied parameters (value = position * ratio),
+// LATIN_HYPERCUBE draws 'samples' points from the continuous [minVal, maxVal] ranges,
+// except the anisotropy, which is stratified over its scroll positions.
+// Parameters that are not varied keep their defaults. A run ends after 'steps' steps
+// or when a stop condition is met, whichever comes first.
+struct SweepSpec
+{
+	enum class MODE
+	{
+		GRID, LATIN_HYPERCUBE,
+	};
+
+	MODE mode = MODE::GRID;
+	GridSize size = { 250, 250 };
+	float timeStep = 0.0001f;
+	int steps = 10000;
+	int samples = 100;
+	unsigned int seed = 0;
+	std::vector<KobayashiSolver::PARAM> params;
+	StopCondition stopCondition;
+	float noiseAmplitude = 0.0f;
+	unsigned long long noiseSeed = 0;
+	int morphologyInterval = 0;	// Steps between morphology samples. 0 disables the analysis.
+
+	// One line that identifies the sweep, stored in the result file to validate a resume.
+	std::string describe() const;
+};
+
+struct SweepRun
+{
+	int id;
+	float param[static_cast<int>(KobayashiSolver::PARAM::COUNT)];
+};
+
+// The runs and their ids only depend on the spec, so a resumed sweep regenerates the same list.
+std::vector<SweepRun> generateSweepRuns(const SweepSpec& spec);
+
+const char* getParameterName(KobayashiSolver::PARAM param);
+bool findParameter(const std::string& name, KobayashiSolver::PARAM& param);
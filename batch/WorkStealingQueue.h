@@ -0,0 +1,73 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// One deque per worker. A worker pops from the front of its own deque and
+// steals from the back of the others when it runs dry.
+// Tasks are whole simulation runs, so a mutex per deque is cheap enough.
+template <typename T>
+class WorkStealingQueue
+{
+public:
+	explicit WorkStealingQueue(int workerCount)
+		:_queues(workerCount) {}
+
+	int getWorkerCount() const
+	{
+		return static_cast<int>(_queues.size());
+	}
+
+	void push(int worker, const T& task)
+	{
+		Queue& queue = _queues[worker];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(task);
+	}
+
+	// Returns false once every deque is empty. No task is pushed while workers run.
+	bool pop(int worker, T& task)
+	{
+		if (_popFront(_queues[worker], task))
+			return true;
+
+		int count = getWorkerCount();
+		for (int i = 1; i < count; i++)
+		{
+			if (_popBack(_queues[(worker + i) % count], task))
+				return true;
+		}
+		return false;
+	}
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<T> tasks;
+	};
+
+	std::vector<Queue> _queues;
+
+	bool _popFront(Queue& queue, T& task)
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+			return false;
+
+		task = queue.tasks.front();
+		queue.tasks.pop_front();
+		return true;
+	}
+
+	bool _popBack(Queue& queue, T& task)
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+			return false;
+
+		task = queue.tasks.back();
+		queue.tasks.pop_back();
+		return true;
+	}
+};
@@ -0,0 +1,150 @@
+// Batch runner for parameter sweeps of the Kobayashi model.
+//
+// CrystalGrowthBatch [options] <output.csv>
+//   --mode grid|lhs        Grid over the scroll positions or Latin hypercube (default: grid)
+//   --vary a,b,...         Varied parameters: tau, epsilon_bar, mu, K, delta, anisotropy, alpha, gamma, t_eq
+//   --samples N            Number of Latin hypercube samples (default: 100)
+//   --seed N               Latin hypercube seed (default: 0)
+//   --size N | NxM         Grid size (default: 250)
+//   --steps N              Maximum steps per run (default: 10000)
+//   --stop-boundary N      Stop when the solid comes within N cells of the edge
+//   --stop-solid F         Stop when the solid fraction reaches F
+//   --stop-steady F        Stop when max |dphi| of a step falls below F
+//   --stop-seconds F       Stop F seconds after the run started
+//   --noise F              Interface noise amplitude (default: 0)
+//   --noise-seed N         Noise seed, shared by every run (default: 0)
+//   --morphology N         Measure the dendrite every N steps into <output.csv>.morphology.csv
+//   --telemetry NAME       Publish live frames to the shared-memory channels NAME-<worker> (POSIX only)
+//   --telemetry-interval N Steps between published frames (default: 10)
+//   --telemetry-downsample K  Average K x K cells per published pixel (default: 1)
+//   --dt F                 Time step (default: 0.0001)
+//   --threads N            Total threads (default: all cores)
+//
+// Running the same command again resumes an interrupted sweep.
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include "SweepRunner.h"
+
+using namespace std;
+
+static int _usage()
+{
+	fprintf(stderr,
+		"usage: CrystalGrowthBatch [--mode grid|lhs] [--vary a,b,...] [--samples N] [--seed N]\n"
+		"                          [--size N|NxM] [--steps N] [--dt F] [--threads N]\n"
+		"                          [--stop-boundary N] [--stop-solid F] [--stop-steady F] [--stop-seconds F]\n"
+		"                          [--noise F] [--noise-seed N] [--morphology N]\n"
+		"                          [--telemetry NAME] [--telemetry-interval N] [--telemetry-downsample K]\n"
+		"                          <output.csv>\n");
+	return 1;
+}
+
+int main(int argc, char* argv[])
+{
+	SweepSpec spec;
+	string outputPath;
+	int threadCount = max(1, static_cast<int>(thread::hardware_concurrency()));
+	string telemetryName;
+	int telemetryInterval = 10;
+	int telemetryDownsample = 1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg.compare(0, 2, "--") != 0)
+		{
+			outputPath = arg;
+			continue;
+		}
+		if (i + 1 >= argc)
+			return _usage();
+
+		string value = argv[++i];
+		if (arg == "--mode")
+		{
+			if (value == "grid")
+				spec.mode = SweepSpec::MODE::GRID;
+			else if (value == "lhs")
+				spec.mode = SweepSpec::MODE::LATIN_HYPERCUBE;
+			else
+				return _usage();
+		}
+		else if (arg == "--vary")
+		{
+			istringstream names(value);
+			string name;
+			while (getline(names, name, ','))
+			{
+				KobayashiSolver::PARAM param;
+				if (!findParameter(name, param))
+				{
+					fprintf(stderr, "unknown parameter: %s\n", name.c_str());
+					return 1;
+				}
+				spec.params.push_back(param);
+			}
+		}
+		else if (arg == "--samples")
+			spec.samples = atoi(value.c_str());
+		else if (arg == "--seed")
+			spec.seed = static_cast<unsigned int>(strtoul(value.c_str(), nullptr, 10));
+		else if (arg == "--size")
+		{
+			if (sscanf(value.c_str(), "%dx%d", &spec.size.x, &spec.size.y) != 2)
+				spec.size.y = spec.size.x;
+		}
+		else if (arg == "--steps")
+			spec.steps = atoi(value.c_str());
+		else if (arg == "--stop-boundary")
+			spec.stopCondition.boundaryMargin = atoi(value.c_str());
+		else if (arg == "--stop-solid")
+			spec.stopCondition.solidFraction = static_cast<float>(atof(value.c_str()));
+		else if (arg == "--stop-steady")
+			spec.stopCondition.steadyDeltaPhi = static_cast<float>(atof(value.c_str()));
+		else if (arg == "--stop-seconds")
+			spec.stopCondition.wallClockSeconds = atof(value.c_str());
+		else if (arg == "--noise")
+			spec.noiseAmplitude = static_cast<float>(atof(value.c_str()));
+		else if (arg == "--noise-seed")
+			spec.noiseSeed = strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "--morphology")
+			spec.morphologyInterval = atoi(value.c_str());
+		else if (arg == "--telemetry")
+			telemetryName = value;
+		else if (arg == "--telemetry-interval")
+			telemetryInterval = atoi(value.c_str());
+		else if (arg == "--telemetry-downsample")
+			telemetryDownsample = atoi(value.c_str());
+		else if (arg == "--dt")
+			spec.timeStep = static_cast<float>(atof(value.c_str()));
+		else if (arg == "--threads")
+			threadCount = atoi(value.c_str());
+		else
+			return _usage();
+	}
+
+	if (outputPath.empty() || spec.size.x < 3 || spec.size.y < 3 || spec.samples < 1)
+		return _usage();
+	if (static_cast<long long>(spec.size.x) * static_cast<long long>(spec.size.y) > INT_MAX)
+	{
+		fprintf(stderr, "the grid must not exceed INT_MAX cells\n");
+		return 1;
+	}
+
+	SweepRunner runner(spec, outputPath, threadCount);
+	if (!telemetryName.empty())
+	{
+#ifdef CRYSTALGROWTH_TELEMETRY
+		runner.setTelemetry(telemetryName, telemetryInterval, telemetryDownsample);
+#else
+		fprintf(stderr, "telemetry requires POSIX shared memory\n");
+		return 1;
+#endif
+	}
+	return runner.run() ? 0 : 1;
+}
@@ -0,0 +1,554 @@
+// Python bindings of KobayashiSolver.
+//
+// import crystalgrowth, numpy
+// sim = crystalgrowth.Kobayashi(250, 250, 0.0001)
+// sim.tau = 0.0004
+// sim.set_stop_condition(boundary_margin=2, seconds=60.0)
+// sim.set_noise(0.01, seed=7)
+// sim.enable_morphology(100)
+// sim.enable_telemetry("crystalgrowth", 10)  # POSIX only; read with CrystalGrowthTelemetryDump
+// sim.step(1000)                  # The GIL is released while stepping.
+// phi = numpy.asarray(sim.phi)    # Zero-copy (y, x) float32 view of the solver's buffer.
+//
+// Ownership: a field object keeps a reference to its Kobayashi object, so the buffer stays
+// valid as long as any view of it is alive. The solver never reallocates its fields
+// (reset() refills them in place), so a view taken once stays attached to the simulation.
+// Views are not synchronized with step() running in another thread; stop_reason, statistics
+// and morphology raise RuntimeError instead.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <climits>
+#include <new>
+#include "KobayashiSolver.h"
+#include "MorphologyAnalyzer.h"
+#ifdef CRYSTALGROWTH_TELEMETRY
+#include "TelemetryPublisher.h"
+#endif
+
+using namespace std;
+
+struct KobayashiObject
+{
+	PyObject_HEAD
+	KobayashiSolver* solver;
+	MorphologyAnalyzer* morphology;
+#ifdef CRYSTALGROWTH_TELEMETRY
+	TelemetryPublisher* telemetry;
+#endif
+	bool stepping;
+};
+
+struct FieldObject
+{
+	PyObject_HEAD
+	KobayashiObject* owner;
+	std::vector<float>* field;
+	Py_ssize_t shape[2];
+	Py_ssize_t strides[2];
+};
+
+static PyTypeObject FieldType = { PyVarObject_HEAD_INIT(NULL, 0) };
+static PyTypeObject KobayashiType = { PyVarObject_HEAD_INIT(NULL, 0) };
+
+
+#pragma region Field
+// ####################################### Field #########################################
+static void Field_dealloc(FieldObject* self)
+{
+	Py_XDECREF(self->owner);
+	Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+// The field is a C-contiguous (y, x) array. Like PyBuffer_FillInfo(), a request without
+// PyBUF_ND gets a flat 1-D buffer.
+static int Field_getbuffer(FieldObject* self, Py_buffer* view, int flags)
+{
+	bool fortran = (flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS;
+	if (fortran && self->shape[0] > 1 && self->shape[1] > 1)
+	{
+		view->obj = NULL;
+		PyErr_SetString(PyExc_BufferError, "the field is not Fortran contiguous");
+		return -1;
+	}
+
+	bool nd = (flags & PyBUF_ND) == PyBUF_ND;
+	view->obj = reinterpret_cast<PyObject*>(self);
+	view->buf = self->field->data();
+	view->len = static_cast<Py_ssize_t>(self->field->size() * sizeof(float));
+	view->readonly = 0;
+	view->itemsize = sizeof(float);
+	view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>("f") : NULL;
+	view->ndim = nd ? 2 : 1;
+	view->shape = nd ? self->shape : NULL;
+	view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+
+	Py_INCREF(self);
+	return 0;
+}
+
+static PyBufferProcs Field_as_buffer = {
+	reinterpret_cast<getbufferproc>(Field_getbuffer),
+	NULL,
+};
+
+static PyObject* Field_new(KobayashiObject* owner, std::vector<float>& field)
+{
+	FieldObject* self = PyObject_New(FieldObject, &FieldType);
+	if (self == NULL)
+		return NULL;
+
+	GridSize size = owner->solver->getGridSize();
+
+	Py_INCREF(owner);
+	self->owner = owner;
+	self->field = &field;
+	self->shape[0] = size.y;
+	self->shape[1] = size.x;
+	self->strides[0] = static_cast<Py_ssize_t>(size.x * sizeof(float));
+	self->strides[1] = sizeof(float);
+
+	return reinterpret_cast<PyObject*>(self);
+}
+// #######################################################################################
+#pragma endregion
+
+
+#pragma region Kobayashi
+// ##################################### Kobayashi #######################################
+static PyObject* Kobayashi_new(PyTypeObject* type, PyObject* args, PyObject* kwds)
+{
+	static const char* kwlist[] = { "x", "y", "time_step", NULL };
+	int x, y;
+	float timeStep = 0.0001f;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "ii|f", const_cast<char**>(kwlist), &x, &y, &timeStep))
+		return NULL;
+
+	// _computeGradientLaplacian() wraps with (i - 1 + x) % x and the nucleus needs 3 cells.
+	if (x < 3 || y < 3)
+	{
+		PyErr_SetString(PyExc_ValueError, "grid size must be at least 3x3");
+		return NULL;
+	}
+	if (static_cast<long long>(x) * static_cast<long long>(y) > INT_MAX)
+	{
+		PyErr_SetString(PyExc_ValueError, "grid size must not exceed INT_MAX cells");
+		return NULL;
+	}
+
+	KobayashiObject* self = reinterpret_cast<KobayashiObject*>(type->tp_alloc(type, 0));
+	if (self == NULL)
+		return NULL;
+
+	// The fields are allocated in the constructor; std::bad_alloc must not cross the C API.
+	try
+	{
+		self->solver = new KobayashiSolver(x, y, timeStep);
+	}
+	catch (const bad_alloc&)
+	{
+		self->solver = NULL;
+	}
+	self->morphology = NULL;
+#ifdef CRYSTALGROWTH_TELEMETRY
+	self->telemetry = NULL;
+#endif
+	self->stepping = false;
+	if (self->solver == NULL)
+	{
+		Py_DECREF(self);
+		return PyErr_NoMemory();
+	}
+
+	return reinterpret_cast<PyObject*>(self);
+}
+
+static void Kobayashi_dealloc(KobayashiObject* self)
+{
+#ifdef CRYSTALGROWTH_TELEMETRY
+	delete self->telemetry;
+#endif
+	delete self->morphology;
+	delete self->solver;
+	Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+static bool Kobayashi_checkIdle(KobayashiObject* self)
+{
+	if (self->stepping)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "the simulation is being stepped in another thread");
+		return false;
+	}
+	return true;
+}
+
+static PyObject* Kobayashi_step(KobayashiObject* self, PyObject* args)
+{
+	Py_ssize_t n = 1;
+	if (!PyArg_ParseTuple(args, "|n", &n))
+		return NULL;
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+
+	KobayashiSolver* solver = self->solver;
+	MorphologyAnalyzer* morphology = self->morphology;
+#ifdef CRYSTALGROWTH_TELEMETRY
+	TelemetryPublisher* telemetry = self->telemetry;
+#endif
+	self->stepping = true;
+
+	Py_ssize_t i = 0;
+
+	Py_BEGIN_ALLOW_THREADS
+	for (; i < n && !solver->isStopped(); i++)
+	{
+		solver->step();
+		if (morphology != NULL)
+			morphology->update();
+#ifdef CRYSTALGROWTH_TELEMETRY
+		if (telemetry != NULL)
+			telemetry->update(*solver);
+#endif
+	}
+	Py_END_ALLOW_THREADS
+
+	self->stepping = false;
+	return PyLong_FromSsize_t(i);
+}
+
+static PyObject* Kobayashi_setStopCondition(KobayashiObject* self, PyObject* args, PyObject* kwds)
+{
+	static const char* kwlist[] = { "boundary_margin", "solid_fraction", "steady_delta_phi", "seconds", NULL };
+	StopCondition condition;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$iffd", const_cast<char**>(kwlist),
+		&condition.boundaryMargin, &condition.solidFraction, &condition.steadyDeltaPhi, &condition.wallClockSeconds))
+		return NULL;
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+
+	self->solver->setStopCondition(condition);
+	Py_RETURN_NONE;
+}
+
+static PyObject* Kobayashi_reset(KobayashiObject* self, PyObject* Py_UNUSED(args))
+{
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+
+	self->solver->resetState();
+	if (self->morphology != NULL)
+		self->morphology->reset();
+	Py_RETURN_NONE;
+}
+
+static PyObject* Kobayashi_resetParameters(KobayashiObject* self, PyObject* Py_UNUSED(args))
+{
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+
+	self->solver->resetParameter();
+	Py_RETURN_NONE;
+}
+
+static PyObject* Kobayashi_enableMorphology(KobayashiObject* self, PyObject* args)
+{
+	int interval;
+	if (!PyArg_ParseTuple(args, "i", &interval))
+		return NULL;
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+
+	delete self->morphology;
+	self->morphology = NULL;
+	if (interval > 0)
+	{
+		self->morphology = new (nothrow) MorphologyAnalyzer(*self->solver, interval);
+		if (self->morphology == NULL)
+			return PyErr_NoMemory();
+		self->morphology->update();
+	}
+	Py_RETURN_NONE;
+}
+
+static PyObject* Kobayashi_setNoise(KobayashiObject* self, PyObject* args, PyObject* kwds)
+{
+	static const char* kwlist[] = { "amplitude", "seed", NULL };
+	float amplitude;
+	unsigned long long seed = 0;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "f|K", const_cast<char**>(kwlist), &amplitude, &seed))
+		return NULL;
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+
+	self->solver->setNoise(amplitude, seed);
+	Py_RETURN_NONE;
+}
+
+static PyObject* Kobayashi_enableTelemetry(KobayashiObject* self, PyObject* args, PyObject* kwds)
+{
+	static const char* kwlist[] = { "name", "interval", "downsample", NULL };
+	const char* name;
+	int interval = 10;
+	int downsample = 1;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "z|ii", const_cast<char**>(kwlist), &name, &interval, &downsample))
+		return NULL;
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+
+#ifdef CRYSTALGROWTH_TELEMETRY
+	delete self->telemetry;
+	self->telemetry = NULL;
+	if (name != NULL)
+	{
+		self->telemetry = new (nothrow) TelemetryPublisher(name, self->solver->getGridSize(), downsample, interval);
+		if (self->telemetry == NULL)
+			return PyErr_NoMemory();
+		if (!self->telemetry->isOpen())
+		{
+			delete self->telemetry;
+			self->telemetry = NULL;
+			PyErr_Format(PyExc_OSError, "cannot create the telemetry channel %s", name);
+			return NULL;
+		}
+		self->telemetry->publish(*self->solver);
+	}
+	Py_RETURN_NONE;
+#else
+	PyErr_SetString(PyExc_NotImplementedError, "telemetry requires POSIX shared memory");
+	return NULL;
+#endif
+}
+
+static PyObject* Kobayashi_getParameter(KobayashiObject* self, void* closure)
+{
+	KobayashiSolver::PARAM param = static_cast<KobayashiSolver::PARAM>(reinterpret_cast<Py_intptr_t>(closure));
+	return PyFloat_FromDouble(self->solver->getParameter(param));
+}
+
+static int Kobayashi_setParameter(KobayashiObject* self, PyObject* value, void* closure)
+{
+	if (value == NULL)
+	{
+		PyErr_SetString(PyExc_AttributeError, "cannot delete a parameter");
+		return -1;
+	}
+	if (!Kobayashi_checkIdle(self))
+		return -1;
+
+	double v = PyFloat_AsDouble(value);
+	if (v == -1.0 && PyErr_Occurred())
+		return -1;
+
+	KobayashiSolver::PARAM param = static_cast<KobayashiSolver::PARAM>(reinterpret_cast<Py_intptr_t>(closure));
+	self->solver->setParameter(param, static_cast<float>(v));
+	return 0;
+}
+
+static PyObject* Kobayashi_getPhi(KobayashiObject* self, void* Py_UNUSED(closure))
+{
+	return Field_new(self, self->solver->getPhi());
+}
+
+static PyObject* Kobayashi_getT(KobayashiObject* self, void* Py_UNUSED(closure))
+{
+	return Field_new(self, self->solver->getT());
+}
+
+static PyObject* Kobayashi_getThreads(KobayashiObject* self, void* Py_UNUSED(closure))
+{
+	return PyLong_FromLong(self->solver->getThreadCount());
+}
+
+static int Kobayashi_setThreads(KobayashiObject* self, PyObject* value, void* Py_UNUSED(closure))
+{
+	if (value == NULL)
+	{
+		PyErr_SetString(PyExc_AttributeError, "cannot delete threads");
+		return -1;
+	}
+	if (!Kobayashi_checkIdle(self))
+		return -1;
+
+	long threads = PyLong_AsLong(value);
+	if (threads == -1 && PyErr_Occurred())
+		return -1;
+
+	self->solver->setThreadCount(static_cast<int>(threads));
+	return 0;
+}
+
+static PyObject* Kobayashi_getStopReason(KobayashiObject* self, void* Py_UNUSED(closure))
+{
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+	if (!self->solver->isStopped())
+		Py_RETURN_NONE;
+	return PyUnicode_FromString(KobayashiSolver::getStopReasonName(self->solver->getStopReason()));
+}
+
+static PyObject* Kobayashi_getStatistics(KobayashiObject* self, void* Py_UNUSED(closure))
+{
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+
+	const StepStatistics& statistics = self->solver->getStatistics();
+	PyObject* bbox = Py_None;
+	if (statistics.minX <= statistics.maxX)
+		bbox = Py_BuildValue("(iiii)", statistics.minX, statistics.minY, statistics.maxX, statistics.maxY);
+	else
+		Py_INCREF(bbox);
+	if (bbox == NULL)
+		return NULL;
+
+	return Py_BuildValue("{s:L,s:f,s:N,s:f}",
+		"step", self->solver->getStepCount(),
+		"solid_fraction", statistics.solidFraction,
+		"bbox", bbox,
+		"max_delta_phi", statistics.maxDeltaPhi);
+}
+
+static PyObject* Kobayashi_getMorphology(KobayashiObject* self, void* Py_UNUSED(closure))
+{
+	// step() appends to the samples with the GIL released.
+	if (!Kobayashi_checkIdle(self))
+		return NULL;
+	if (self->morphology == NULL)
+		Py_RETURN_NONE;
+
+	const std::vector<MorphologySample>& samples = self->morphology->getSamples();
+	PyObject* list = PyList_New(static_cast<Py_ssize_t>(samples.size()));
+	if (list == NULL)
+		return NULL;
+
+	for (size_t k = 0; k < samples.size(); k++)
+	{
+		const MorphologySample& sample = samples[k];
+		PyObject* item = Py_BuildValue("(Lffffif)", sample.step, sample.time,
+			sample.tipDistance, sample.tipVelocity, sample.tipRadius, sample.armCount, sample.contourLength);
+		if (item == NULL)
+		{
+			Py_DECREF(list);
+			return NULL;
+		}
+		PyList_SET_ITEM(list, static_cast<Py_ssize_t>(k), item);
+	}
+	return list;
+}
+
+static PyObject* Kobayashi_getShape(KobayashiObject* self, void* Py_UNUSED(closure))
+{
+	GridSize size = self->solver->getGridSize();
+	return Py_BuildValue("(ii)", size.y, size.x);
+}
+
+#define PARAMETER_GETSET(name, param) \
+	{ const_cast<char*>(name), \
+	  reinterpret_cast<getter>(Kobayashi_getParameter), \
+	  reinterpret_cast<setter>(Kobayashi_setParameter), NULL, \
+	  reinterpret_cast<void*>(static_cast<Py_intptr_t>(KobayashiSolver::PARAM::param)) }
+
+static PyGetSetDef Kobayashi_getset[] = {
+	PARAMETER_GETSET("tau", TAU),
+	PARAMETER_GETSET("epsilon_bar", EPLSILONBAR),
+	PARAMETER_GETSET("mu", MU),
+	PARAMETER_GETSET("K", K),
+	PARAMETER_GETSET("delta", DELTA),
+	PARAMETER_GETSET("anisotropy", ANISOTROPY),
+	PARAMETER_GETSET("alpha", ALPHA),
+	PARAMETER_GETSET("gamma", GAMMA),
+	PARAMETER_GETSET("t_eq", TEQ),
+	{ const_cast<char*>("phi"), reinterpret_cast<getter>(Kobayashi_getPhi), NULL,
+		const_cast<char*>("Phase field as a zero-copy (y, x) float32 buffer."), NULL },
+	{ const_cast<char*>("t"), reinterpret_cast<getter>(Kobayashi_getT), NULL,
+		const_cast<char*>("Temperature field as a zero-copy (y, x) float32 buffer."), NULL },
+	{ const_cast<char*>("threads"), reinterpret_cast<getter>(Kobayashi_getThreads), reinterpret_cast<setter>(Kobayashi_setThreads),
+		const_cast<char*>("Number of threads used by step()."), NULL },
+	{ const_cast<char*>("stop_reason"), reinterpret_cast<getter>(Kobayashi_getStopReason), NULL,
+		const_cast<char*>("Name of the stop condition that ended the run, or None."), NULL },
+	{ const_cast<char*>("statistics"), reinterpret_cast<getter>(Kobayashi_getStatistics), NULL,
+		const_cast<char*>("Reductions of the last step: step, solid_fraction, bbox (x0, y0, x1, y1) of phi > 0.5, max_delta_phi."), NULL },
+	{ const_cast<char*>("morphology"), reinterpret_cast<getter>(Kobayashi_getMorphology), NULL,
+		const_cast<char*>("Morphology time series as (step, time, tip_distance, tip_velocity, tip_radius, arm_count,\n"
+			"contour_length) tuples, or None if enable_morphology() was not called."), NULL },
+	{ const_cast<char*>("shape"), reinterpret_cast<getter>(Kobayashi_getShape), NULL,
+		const_cast<char*>("Grid shape as (y, x)."), NULL },
+	{ NULL }
+};
+
+#undef PARAMETER_GETSET
+
+static PyMethodDef Kobayashi_methods[] = {
+	{ "step", reinterpret_cast<PyCFunction>(Kobayashi_step), METH_VARARGS,
+		"step(n=1)\nAdvance the simulation up to n steps with the GIL released.\n"
+		"Returns the number of steps taken, which is less than n if a stop condition was met." },
+	{ "set_stop_condition", reinterpret_cast<PyCFunction>(Kobayashi_setStopCondition), METH_VARARGS | METH_KEYWORDS,
+		"set_stop_condition(*, boundary_margin=-1, solid_fraction=0, steady_delta_phi=0, seconds=0)\n"
+		"Stop conditions checked after every step. Omitted or non-positive values are disabled.\n"
+		"seconds is wall-clock time since the first step after construction or reset()." },
+	{ "set_noise", reinterpret_cast<PyCFunction>(Kobayashi_setNoise), METH_VARARGS | METH_KEYWORDS,
+		"set_noise(amplitude, seed=0)\nInterface noise keyed on (seed, step, cell). The result does not depend on threads." },
+	{ "enable_morphology", reinterpret_cast<PyCFunction>(Kobayashi_enableMorphology), METH_VARARGS,
+		"enable_morphology(interval)\nMeasure the dendrite every interval steps while stepping. 0 disables it." },
+	{ "enable_telemetry", reinterpret_cast<PyCFunction>(Kobayashi_enableTelemetry), METH_VARARGS | METH_KEYWORDS,
+		"enable_telemetry(name, interval=10, downsample=1)\n"
+		"Publish phi/T frames every interval steps to the shared-memory channel name. None disables it." },
+	{ "reset", reinterpret_cast<PyCFunction>(Kobayashi_reset), METH_NOARGS,
+		"Reset the fields to the initial nucleus and clear the stop reason." },
+	{ "reset_parameters", reinterpret_cast<PyCFunction>(Kobayashi_resetParameters), METH_NOARGS,
+		"Reset the nine model parameters to their defaults." },
+	{ NULL }
+};
+// #######################################################################################
+#pragma endregion
+
+
+static PyModuleDef crystalgrowthModule = {
+	PyModuleDef_HEAD_INIT,
+	"crystalgrowth",
+	"Kobayashi phase-field model of dendritic crystal growth.",
+	-1,
+	NULL,
+};
+
+PyMODINIT_FUNC PyInit_crystalgrowth(void)
+{
+	FieldType.tp_name = "crystalgrowth.Field";
+	FieldType.tp_doc = "Zero-copy view of a solver field. Use numpy.asarray() or memoryview().";
+	FieldType.tp_basicsize = sizeof(FieldObject);
+	FieldType.tp_flags = Py_TPFLAGS_DEFAULT;
+	FieldType.tp_dealloc = reinterpret_cast<destructor>(Field_dealloc);
+	FieldType.tp_as_buffer = &Field_as_buffer;
+
+	KobayashiType.tp_name = "crystalgrowth.Kobayashi";
+	KobayashiType.tp_doc = "Kobayashi(x, y, time_step=0.0001)\nKobayashi phase-field solver.";
+	KobayashiType.tp_basicsize = sizeof(KobayashiObject);
+	KobayashiType.tp_flags = Py_TPFLAGS_DEFAULT;
+	KobayashiType.tp_new = Kobayashi_new;
+	KobayashiType.tp_dealloc = reinterpret_cast<destructor>(Kobayashi_dealloc);
+	KobayashiType.tp_methods = Kobayashi_methods;
+	KobayashiType.tp_getset = Kobayashi_getset;
+
+	if (PyType_Ready(&FieldType) < 0 || PyType_Ready(&KobayashiType) < 0)
+		return NULL;
+
+	PyObject* module = PyModule_Create(&crystalgrowthModule);
+	if (module == NULL)
+		return NULL;
+
+	Py_INCREF(&KobayashiType);
+	if (PyModule_AddObject(module, "Kobayashi", reinterpret_cast<PyObject*>(&KobayashiType)) < 0)
+	{
+		Py_DECREF(&KobayashiType);
+		Py_DECREF(module);
+		return NULL;
+	}
+
+	return module;
+}
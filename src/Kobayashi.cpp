@@ -5,221 +5,15 @@ using namespace DirectX;
 using namespace DXViewer::xmfloat3;
 
 Kobayashi::Kobayashi(int x, int y, float timeStep)
+	:KobayashiSolver(x, y, timeStep)
 {
-	_objectCount = { x, y };
-
-	// The scroll position is stored separately as an integer due to the floating point precision.
-	_crystalParameter.push_back(
-		CrystalParameter(
-								//  float  :   value      min      max     stride
-								//  int	   :     -         -        -        -
-								//		       float / int
-			ScrollParameter<float&, float>(		  _tau, 0.0001f, 0.0009f, 0.0001f), 
-			ScrollParameter<int, int>	  (			 3,      1,       9,       1 ),
-											    0.0001f));
-	_crystalParameter.push_back(
-		CrystalParameter(
-			ScrollParameter<float&, float>(_epsilonBar,  0.006f,  0.015f,  0.001f), 
-			ScrollParameter<int, int>	  (         10,      6,      15,       1 ),
-												 0.001f));
-	_crystalParameter.push_back(
-		CrystalParameter(
-			ScrollParameter<float&, float>(		   _mu,    0.5f,    1.4f,    0.1f), 
-			ScrollParameter<int, int>	  (			10,      5,      14,       1 ),
-												   0.1f));
-	_crystalParameter.push_back(
-		CrystalParameter(
-			ScrollParameter<float&, float>(			_K,    1.0f,    1.9f,    0.1f), 
-			ScrollParameter<int, int>	  (			16,    10,      19,        1 ),
-												   0.1f));
-	_crystalParameter.push_back(
-		CrystalParameter(
-			ScrollParameter<float&, float>(		_delta,   0.01f,   0.09f,   0.01f), 
-			ScrollParameter<int, int>	  (		     5,      1,       9,       1 ),
-												  0.01f));
-	_crystalParameter.push_back(
-		CrystalParameter(
-			ScrollParameter<float&, float>(_anisotropy,    2.0f,    8.0f,      1.0f), 
-			ScrollParameter<int, int>	  (          6,    2,       8,         1   ), 
-												   1.0f));
-	_crystalParameter.push_back(
-		CrystalParameter(
-			ScrollParameter<float&, float>(		_alpha,    0.7f,    1.2f,    0.1f), 
-			ScrollParameter<int, int>	  (			 9,      7,     12,        1 ),
-												   0.1f));
-	_crystalParameter.push_back(
-		CrystalParameter(
-			ScrollParameter<float&, float>(		_gamma,   10.0f,   20.0f,      1.0f), 
-			ScrollParameter<int, int>	  (		    10,   10,      20,         1   ),
-												   1.0f));
-	_crystalParameter.push_back(
-		CrystalParameter(
-			ScrollParameter<float&, float>(		  _tEq,    0.5f,    1.5f,    0.1f), 
-			ScrollParameter<int, int>	  (		    10,      5,     15,        1 ),
-												   0.1f));
-
-	_dx = 0.03f;
-	_dy = 0.03f;
-	_dt = timeStep;
-
-	_parameterInit();
-	_vectorInit();
+	_scrollbar.assign(static_cast<int>(PARAM::COUNT), nullptr);
 }
 
 Kobayashi::~Kobayashi()
 {
 }
 
-void Kobayashi::_parameterInit()
-{
-	//
-	_tau		= 0.0003f;
-	_epsilonBar = 0.010f;		// Mean of epsilon. scaling factor that determines how much the microscopic front is magnified
-	_mu		    = 1.0f;
-	_K			= 1.6f;			// Latent heat 
-	_delta		= 0.05f;		// Strength of anisotropy (speed of growth in preferred directions)
-	_anisotropy = 6.0f;			// Degree of anisotropy
-	_alpha		= 0.9f;
-	_gamma		= 10.0f;
-	_tEq		= 1.0f;
-	//
-
-	_crystalParameter[static_cast<int>(COM::TAU)].param_i.value			= 3;
-	_crystalParameter[static_cast<int>(COM::EPLSILONBAR)].param_i.value = 10;
-	_crystalParameter[static_cast<int>(COM::MU)].param_i.value			= 10;
-	_crystalParameter[static_cast<int>(COM::K)].param_i.value			= 16;
-	_crystalParameter[static_cast<int>(COM::DELTA)].param_i.value		= 5;
-	_crystalParameter[static_cast<int>(COM::ANISOTROPY)].param_i.value  = 6;
-	_crystalParameter[static_cast<int>(COM::ALPHA)].param_i.value		= 9;
-	_crystalParameter[static_cast<int>(COM::GAMMA)].param_i.value		= 10;
-	_crystalParameter[static_cast<int>(COM::TEQ)].param_i.value			= 10;
-}
-
-void Kobayashi::_vectorInit()
-{
-	size_t vSize = static_cast<size_t>(_objectCount.x) * static_cast<size_t>(_objectCount.y);
-	_phi.assign(vSize, 0.0f);
-	_t.assign(vSize, 0.0f);
-	_gradPhiX.assign(vSize, 0.0f);
-	_gradPhiY.assign(vSize, 0.0f);
-	_lapPhi.assign(vSize, 0.0f);
-	_lapT.assign(vSize, 0.0f);
-	_angl.assign(vSize, 0.0f);
-	_epsilon.assign(vSize, 0.0f);
-	_epsilonDeriv.assign(vSize, 0.0f);
-
-
-	// Create the neuclei
-	_createNucleus(_objectCount.x / 2, _objectCount.y / 2);
-}
-
-void Kobayashi::_createNucleus(int x, int y)
-{
-	_phi[_INDEX(x, y)] = 1.0f;
-	_phi[_INDEX(x - 1, y)] = 1.0f;
-	_phi[_INDEX(x + 1, y)] = 1.0f;
-	_phi[_INDEX(x, y - 1)] = 1.0f;
-	_phi[_INDEX(x, y + 1)] = 1.0f;
-}
-
-void Kobayashi::_computeGradientLaplacian()
-{
-
-	for (int j = 0; j < _objectCount.y; j++)
-	{
-		for (int i = 0; i < _objectCount.x; i++)
-		{
-
-			int i_plus = (i + 1) % _objectCount.x;
-			int i_minus = ((i - 1) + _objectCount.x) % _objectCount.x;
-			int j_plus = (j + 1) % _objectCount.y;
-			int j_minus = ((j - 1) + _objectCount.y) % _objectCount.y;
-
-
-			_gradPhiX[_INDEX(i, j)] = (_phi[_INDEX(i_plus, j)] - _phi[_INDEX(i_minus, j)]) / _dx;
-			_gradPhiY[_INDEX(i, j)] = (_phi[_INDEX(i, j_plus)] - _phi[_INDEX(i, j_minus)]) / _dy;
-
-			_lapPhi[_INDEX(i, j)] = 
-				(2.0f * (_phi[_INDEX(i_plus, j)] + _phi[_INDEX(i_minus, j)] + _phi[_INDEX(i, j_plus)] + _phi[_INDEX(i, j_minus)])
-				+ _phi[_INDEX(i_plus, j_plus)] + _phi[_INDEX(i_minus, j_minus)] + _phi[_INDEX(i_minus, j_plus)] + _phi[_INDEX(i_plus, j_minus)]
-				- 12.0f * _phi[_INDEX(i, j)])
-				/ (3.0f * _dx * _dx);
-			_lapT[_INDEX(i, j)] = 
-				(2.0f * (_t[_INDEX(i_plus, j)] + _t[_INDEX(i_minus, j)] + _t[_INDEX(i, j_plus)] + _t[_INDEX(i, j_minus)])
-				+ _t[_INDEX(i_plus, j_plus)] + _t[_INDEX(i_minus, j_minus)] + _t[_INDEX(i_minus, j_plus)] + _t[_INDEX(i_plus, j_minus)]
-				- 12.0f * _t[_INDEX(i, j)])
-				/ (3.0f * _dx * _dx);
-
-
-			if (_gradPhiX[_INDEX(i, j)] <= +FLT_EPSILON && _gradPhiX[_INDEX(i, j)] >= -FLT_EPSILON) // _gradPhiX[i][j] == 0.0f
-				if (_gradPhiY[_INDEX(i, j)] < -FLT_EPSILON)
-					_angl[_INDEX(i, j)] = -0.5f * PI_F;
-				else if (_gradPhiY[_INDEX(i, j)] > +FLT_EPSILON)
-					_angl[_INDEX(i, j)] = 0.5f * PI_F;
-
-			if (_gradPhiX[_INDEX(i, j)] > +FLT_EPSILON)
-				if (_gradPhiY[_INDEX(i, j)] < -FLT_EPSILON)
-					_angl[_INDEX(i, j)] = 2.0f * PI_F + atan(_gradPhiY[_INDEX(i, j)] / _gradPhiX[_INDEX(i, j)]);
-				else if (_gradPhiY[_INDEX(i, j)] > +FLT_EPSILON)
-					_angl[_INDEX(i, j)] = atan(_gradPhiY[_INDEX(i, j)] / _gradPhiX[_INDEX(i, j)]);
-
-			if (_gradPhiX[_INDEX(i, j)] < -FLT_EPSILON)
-				_angl[_INDEX(i, j)] = PI_F + atan(_gradPhiY[_INDEX(i, j)] / _gradPhiX[_INDEX(i, j)]);
-
-			
-			_epsilon[_INDEX(i, j)] = _epsilonBar * (1.0f + _delta * cos(_anisotropy * _angl[_INDEX(i, j)]));
-			_epsilonDeriv[_INDEX(i, j)] = -_epsilonBar * _anisotropy * _delta * sin(_anisotropy * _angl[_INDEX(i, j)]);
-
-		}
-	}
-}
-
-void Kobayashi::_evolution()
-{
-	for (int j = 0; j < _objectCount.y; j++)
-	{
-		for (int i = 0; i < _objectCount.x; i++)
-		{
-
-			int i_plus = (i + 1) % _objectCount.x;
-			int i_minus = ((i - 1) + _objectCount.x) % _objectCount.x;
-			int j_plus = (j + 1) % _objectCount.y;
-			int j_minus = ((j - 1) + _objectCount.y) % _objectCount.y;
-
-
-			float gradEpsPowX = 
-				(_epsilon[_INDEX(i_plus, j)] * _epsilon[_INDEX(i_plus, j)] 
-					- _epsilon[_INDEX(i_minus, j)] * _epsilon[_INDEX(i_minus, j)]) / _dx;
-			float gradEpsPowY = 
-				(_epsilon[_INDEX(i, j_plus)] * _epsilon[_INDEX(i, j_plus)] 
-					- _epsilon[_INDEX(i, j_minus)] * _epsilon[_INDEX(i, j_minus)]) / _dy;
-
-			float term1 = (_epsilon[_INDEX(i, j_plus)] * _epsilonDeriv[_INDEX(i, j_plus)] * _gradPhiX[_INDEX(i, j_plus)]
-				- _epsilon[_INDEX(i, j_minus)] * _epsilonDeriv[_INDEX(i, j_minus)] * _gradPhiX[_INDEX(i, j_minus)])
-				/ _dy;
-
-			float term2 = -(_epsilon[_INDEX(i_plus, j)] * _epsilonDeriv[_INDEX(i_plus, j)] * _gradPhiY[_INDEX(i_plus, j)]
-				- _epsilon[_INDEX(i_minus, j)] * _epsilonDeriv[_INDEX(i_minus, j)] * _gradPhiY[_INDEX(i_minus, j)])
-				/ _dx;
-			float term3 = gradEpsPowX * _gradPhiX[_INDEX(i, j)] + gradEpsPowY * _gradPhiY[_INDEX(i, j)];
-
-			float m = _alpha / PI_F * atan(_gamma*(_tEq - _t[_INDEX(i, j)]));
-
-			float oldPhi = _phi[_INDEX(i, j)];
-			float oldT = _t[_INDEX(i, j)];
-
-			_phi[_INDEX(i, j)] = _phi[_INDEX(i, j)] +
-				(term1 + term2 + _epsilon[_INDEX(i, j)] * _epsilon[_INDEX(i, j)] * _lapPhi[_INDEX(i, j)]
-					+ term3
-					+ oldPhi * (1.0f - oldPhi)*(oldPhi - 0.5f + m))*_dt / _tau;
-			_t[_INDEX(i, j)] = oldT + _lapT[_INDEX(i, j)] * _dt + _K * (_phi[_INDEX(i, j)] - oldPhi);
-
-
-		}
-
-	}
-}
-
 
 #pragma region implementation
 // ################################## implementation ####################################
@@ -229,8 +23,7 @@ void Kobayashi::iUpdate()
 	clock_t startTime = clock();
 	for (int i = 0; i < 10; i++)
 	{
-		_computeGradientLaplacian();
-		_evolution();
+		step();
 	}
 	clock_t endTime = clock();
 
@@ -240,7 +33,7 @@ void Kobayashi::iUpdate()
 
 void Kobayashi::iResetSimulationState(std::vector<ConstantBuffer>& constantBuffer)
 {
-	_vectorInit();
+	resetState();
 
 	_dxapp->update();
 	_dxapp->draw();
@@ -408,7 +201,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		69, 45, 80, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 	CreateWindow(L"static", to_wstring(_tau).c_str(), WS_CHILD | WS_VISIBLE,
 		105, 45, 44, 20, hwnd, reinterpret_cast<HMENU>(COM::TAU), hInstance, NULL);
-	_crystalParameter[static_cast<int>(COM::TAU)].scrollbar = 
+	_scrollbar[static_cast<int>(COM::TAU)] = 
 		CreateWindow(L"scrollbar", NULL, WS_CHILD | WS_VISIBLE | SBS_HORZ,
 			167, 45, 100, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 
@@ -417,7 +210,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		18, 65, 80, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 	CreateWindow(L"static", to_wstring(_epsilonBar).c_str(), WS_CHILD | WS_VISIBLE,
 		105, 65, 35, 20, hwnd, reinterpret_cast<HMENU>(COM::EPLSILONBAR), hInstance, NULL);
-	_crystalParameter[static_cast<int>(COM::EPLSILONBAR)].scrollbar =
+	_scrollbar[static_cast<int>(COM::EPLSILONBAR)] =
 		CreateWindow(L"scrollbar", NULL, WS_CHILD | WS_VISIBLE | SBS_HORZ,
 			167, 65, 100, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 
@@ -426,7 +219,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		69, 85, 80, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 	CreateWindow(L"static", to_wstring(_mu).c_str(), WS_CHILD | WS_VISIBLE,
 		105, 85, 20, 20, hwnd, reinterpret_cast<HMENU>(COM::MU), hInstance, NULL);
-	_crystalParameter[static_cast<int>(COM::MU)].scrollbar =
+	_scrollbar[static_cast<int>(COM::MU)] =
 		CreateWindow(L"scrollbar", NULL, WS_CHILD | WS_VISIBLE | SBS_HORZ,
 			167, 85, 100, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 
@@ -435,7 +228,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		80, 105, 80, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 	CreateWindow(L"static", to_wstring(_K).c_str(), WS_CHILD | WS_VISIBLE,
 		105, 105, 20, 20, hwnd, reinterpret_cast<HMENU>(COM::K), hInstance, NULL);
-	_crystalParameter[static_cast<int>(COM::K)].scrollbar =
+	_scrollbar[static_cast<int>(COM::K)] =
 		CreateWindow(L"scrollbar", NULL, WS_CHILD | WS_VISIBLE | SBS_HORZ,
 			167, 105, 100, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 
@@ -444,7 +237,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		57, 125, 40, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 	CreateWindow(L"static", to_wstring(_delta).c_str(), WS_CHILD | WS_VISIBLE,
 		105, 126, 28, 20, hwnd, reinterpret_cast<HMENU>(COM::DELTA), hInstance, NULL);
-	_crystalParameter[static_cast<int>(COM::DELTA)].scrollbar =
+	_scrollbar[static_cast<int>(COM::DELTA)] =
 		CreateWindow(L"scrollbar", NULL, WS_CHILD | WS_VISIBLE | SBS_HORZ,
 			167, 125, 100, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 
@@ -453,7 +246,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		20, 145, 80, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 	CreateWindow(L"static", to_wstring(_anisotropy).c_str(), WS_CHILD | WS_VISIBLE,
 		105, 146, 20, 20, hwnd, reinterpret_cast<HMENU>(COM::ANISOTROPY), hInstance, NULL);
-	_crystalParameter[static_cast<int>(COM::ANISOTROPY)].scrollbar = 
+	_scrollbar[static_cast<int>(COM::ANISOTROPY)] = 
 		CreateWindow(L"scrollbar", NULL, WS_CHILD | WS_VISIBLE | SBS_HORZ,
 			167, 145, 100, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 
@@ -462,7 +255,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		53, 165, 80, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 	CreateWindow(L"static", to_wstring(_alpha).c_str(), WS_CHILD | WS_VISIBLE,
 		105, 166, 20, 20, hwnd, reinterpret_cast<HMENU>(COM::ALPHA), hInstance, NULL);
-	_crystalParameter[static_cast<int>(COM::ALPHA)].scrollbar =
+	_scrollbar[static_cast<int>(COM::ALPHA)] =
 		CreateWindow(L"scrollbar", NULL, WS_CHILD | WS_VISIBLE | SBS_HORZ,
 			167, 165, 100, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 
@@ -471,7 +264,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		41, 185, 80, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 	CreateWindow(L"static", to_wstring(_gamma).c_str(), WS_CHILD | WS_VISIBLE,
 		105, 186, 28, 20, hwnd, reinterpret_cast<HMENU>(COM::GAMMA), hInstance, NULL);
-	_crystalParameter[static_cast<int>(COM::GAMMA)].scrollbar =
+	_scrollbar[static_cast<int>(COM::GAMMA)] =
 		CreateWindow(L"scrollbar", NULL, WS_CHILD | WS_VISIBLE | SBS_HORZ,
 			167, 185, 100, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 
@@ -480,7 +273,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		68, 205, 80, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 	CreateWindow(L"static", to_wstring(_tEq).c_str(), WS_CHILD | WS_VISIBLE,
 		105, 206, 20, 20, hwnd, reinterpret_cast<HMENU>(COM::TEQ), hInstance, NULL);
-	_crystalParameter[static_cast<int>(COM::TEQ)].scrollbar =
+	_scrollbar[static_cast<int>(COM::TEQ)] =
 		CreateWindow(L"scrollbar", NULL, WS_CHILD | WS_VISIBLE | SBS_HORZ,
 			167, 205, 100, 20, hwnd, reinterpret_cast<HMENU>(-1), hInstance, NULL);
 
@@ -495,7 +288,7 @@ void Kobayashi::iWMCreate(HWND hwnd, HINSTANCE hInstance)
 		int minValue = _crystalParameter[i].param_i.minVal;
 		int maxValue = _crystalParameter[i].param_i.maxVal;
 		int value = _crystalParameter[i].param_i.value;
-		HWND scrollbar = _crystalParameter[i].scrollbar;
+		HWND scrollbar = _scrollbar[i];
 
 		SetScrollRange(scrollbar, SB_CTL, minValue, maxValue, TRUE);
 		SetScrollPos(scrollbar, SB_CTL, value, TRUE);
@@ -518,7 +311,7 @@ void Kobayashi::iWMCommand(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam, HI
 				float& value = _crystalParameter[i].param_f.value;
 				float stride = _crystalParameter[i].param_f.stride;
 				int value_int = _crystalParameter[i].param_i.value;
-				HWND scrollbar = _crystalParameter[i].scrollbar;
+				HWND scrollbar = _scrollbar[i];
 
 				SetScrollPos(scrollbar, SB_CTL, value_int, TRUE);
 				SetDlgItemText(hwnd, i, to_wstring(value).c_str());
@@ -557,21 +350,21 @@ void Kobayashi::iWMHScroll(HWND hwnd, WPARAM wParam, LPARAM lParam, HINSTANCE hI
 	HWND iparam = reinterpret_cast<HWND>(lParam);
 
 	int index = 0;
-	if (iparam == _crystalParameter[static_cast<int>(COM::TAU)].scrollbar)
+	if (iparam == _scrollbar[static_cast<int>(COM::TAU)])
 		index = static_cast<int>(COM::TAU);
-	else if (iparam == _crystalParameter[static_cast<int>(COM::EPLSILONBAR)].scrollbar)
+	else if (iparam == _scrollbar[static_cast<int>(COM::EPLSILONBAR)])
 		index = static_cast<int>(COM::EPLSILONBAR);
-	else if (iparam == _crystalParameter[static_cast<int>(COM::MU)].scrollbar)
+	else if (iparam == _scrollbar[static_cast<int>(COM::MU)])
 		index = static_cast<int>(COM::MU);
-	else if (iparam == _crystalParameter[static_cast<int>(COM::K)].scrollbar)
+	else if (iparam == _scrollbar[static_cast<int>(COM::K)])
 		index = static_cast<int>(COM::K);
-	else if (iparam == _crystalParameter[static_cast<int>(COM::DELTA)].scrollbar)
+	else if (iparam == _scrollbar[static_cast<int>(COM::DELTA)])
 		index = static_cast<int>(COM::DELTA);
-	else if (iparam == _crystalParameter[static_cast<int>(COM::ANISOTROPY)].scrollbar)
+	else if (iparam == _scrollbar[static_cast<int>(COM::ANISOTROPY)])
 		index = static_cast<int>(COM::ANISOTROPY);
-	else if (iparam == _crystalParameter[static_cast<int>(COM::ALPHA)].scrollbar)
+	else if (iparam == _scrollbar[static_cast<int>(COM::ALPHA)])
 		index = static_cast<int>(COM::ALPHA);
-	else if (iparam == _crystalParameter[static_cast<int>(COM::GAMMA)].scrollbar)
+	else if (iparam == _scrollbar[static_cast<int>(COM::GAMMA)])
 		index = static_cast<int>(COM::GAMMA);
 	else
 		index = static_cast<int>(COM::TEQ);
@@ -1,35 +1,9 @@
 #pragma once
 #include "Win32App.h"// This includes ISimulation.h.
 					  // Win32App is required in main().
+#include "KobayashiSolver.h"
 
-template <typename T, typename U>
-struct ScrollParameter
-{
-	ScrollParameter(T valu, U minVa, U maxVa, U strid)
-		:value(valu), minVal(minVa), maxVal(maxVa), stride(strid) {}
-	T value;
-	U minVal;
-	U maxVal;
-	U stride;
-};
-
-struct CrystalParameter
-{
-	CrystalParameter(
-		ScrollParameter<float&, float> param_float, 
-		ScrollParameter<int, int> param_int,
-		float rati)
-		:param_f(param_float), param_i(param_int), ratio(rati) {}
-
-	ScrollParameter<float&, float> param_f;
-	ScrollParameter<int, int> param_i;
-	float ratio;
-
-	HWND scrollbar = nullptr;
-};
-
-
-class Kobayashi : public ISimulation
+class Kobayashi : public ISimulation, public KobayashiSolver
 {
 public:
 	Kobayashi(int x, int y, float timeStep);
@@ -82,41 +56,9 @@ private :
 
 	std::vector<Vertex> _vertices;
 	std::vector<unsigned int> _indices;
-	DirectX::XMINT2 _objectCount = { 0, 0 };
 
 	DX12App* _dxapp = nullptr;
 	float _updateFlag = true;
 
-	//
-	inline int _INDEX(int i, int j) { return (i + _objectCount.x * j); };
-
-	std::vector<CrystalParameter> _crystalParameter;
-	float _dx;
-	float _dy;
-	float _dt;
-	float _tau;
-	float _epsilonBar;
-	float _mu;
-	float _K;
-	float _delta;
-	float _anisotropy;
-	float _alpha;
-	float _gamma;
-	float _tEq;
-
-	std::vector<float> _phi;
-	std::vector<float> _t;
-	std::vector<float> _epsilon;
-	std::vector<float> _epsilonDeriv;
-	std::vector<float> _gradPhiX;
-	std::vector<float> _gradPhiY;
-	std::vector<float> _lapPhi;
-	std::vector<float> _lapT;
-	std::vector<float> _angl;
-	
-	void _parameterInit();
-	void _vectorInit();
-	void _createNucleus(int x, int y);
-	void _computeGradientLaplacian();
-	void _evolution();
+	std::vector<HWND> _scrollbar;
 };
@@ -0,0 +1,546 @@
+#include "KobayashiSolver.h"
+#include "Philox.h"
+
+using namespace std;
+
+static const float PI_F = 3.14159265358979f;
+
+KobayashiSolver::KobayashiSolver(int x, int y, float timeStep)
+{
+	_objectCount = { x, y };
+
+	// The scroll position is stored separately as an integer due to the floating point precision.
+	_crystalParameter.push_back(
+		CrystalParameter(
+								//  float  :   value      min      max     stride
+								//  int	   :     -         -        -        -
+								//		       float / int
+			ScrollParameter<float&, float>(		  _tau, 0.0001f, 0.0009f, 0.0001f), 
+			ScrollParameter<int, int>	  (			 3,      1,       9,       1 ),
+											    0.0001f));
+	_crystalParameter.push_back(
+		CrystalParameter(
+			ScrollParameter<float&, float>(_epsilonBar,  0.006f,  0.015f,  0.001f), 
+			ScrollParameter<int, int>	  (         10,      6,      15,       1 ),
+												 0.001f));
+	_crystalParameter.push_back(
+		CrystalParameter(
+			ScrollParameter<float&, float>(		   _mu,    0.5f,    1.4f,    0.1f), 
+			ScrollParameter<int, int>	  (			10,      5,      14,       1 ),
+												   0.1f));
+	_crystalParameter.push_back(
+		CrystalParameter(
+			ScrollParameter<float&, float>(			_K,    1.0f,    1.9f,    0.1f), 
+			ScrollParameter<int, int>	  (			16,    10,      19,        1 ),
+												   0.1f));
+	_crystalParameter.push_back(
+		CrystalParameter(
+			ScrollParameter<float&, float>(		_delta,   0.01f,   0.09f,   0.01f), 
+			ScrollParameter<int, int>	  (		     5,      1,       9,       1 ),
+												  0.01f));
+	_crystalParameter.push_back(
+		CrystalParameter(
+			ScrollParameter<float&, float>(_anisotropy,    2.0f,    8.0f,      1.0f), 
+			ScrollParameter<int, int>	  (          6,    2,       8,         1   ), 
+												   1.0f));
+	_crystalParameter.push_back(
+		CrystalParameter(
+			ScrollParameter<float&, float>(		_alpha,    0.7f,    1.2f,    0.1f), 
+			ScrollParameter<int, int>	  (			 9,      7,     12,        1 ),
+												   0.1f));
+	_crystalParameter.push_back(
+		CrystalParameter(
+			ScrollParameter<float&, float>(		_gamma,   10.0f,   20.0f,      1.0f), 
+			ScrollParameter<int, int>	  (		    10,   10,      20,         1   ),
+												   1.0f));
+	_crystalParameter.push_back(
+		CrystalParameter(
+			ScrollParameter<float&, float>(		  _tEq,    0.5f,    1.5f,    0.1f), 
+			ScrollParameter<int, int>	  (		    10,      5,     15,        1 ),
+												   0.1f));
+
+	_dx = 0.03f;
+	_dy = 0.03f;
+	_dt = timeStep;
+	_bandStatistics.resize(_threadCount);
+
+	_parameterInit();
+	_vectorInit();
+}
+
+KobayashiSolver::~KobayashiSolver()
+{
+	_stopWorkers();
+}
+
+void KobayashiSolver::step()
+{
+	if (_stopReason != STOP::NONE)
+		return;
+
+	if (_stepCount == 0)
+		_startTime = chrono::steady_clock::now();
+
+	if (_threadCount <= 1)
+	{
+		_computeGradientLaplacian(0, 0, _objectCount.y);
+		_evolution(0, 0, _objectCount.y);
+	}
+	else
+	{
+		{
+			lock_guard<mutex> lock(_poolMutex);
+			_poolRunning = _threadCount - 1;
+			_poolGeneration++;
+		}
+		_poolWake.notify_all();
+
+		_stepBand(0);
+
+		unique_lock<mutex> lock(_poolMutex);
+		_poolDone.wait(lock, [this] { return _poolRunning == 0; });
+	}
+
+	_reduceStatistics();
+	_stepCount++;
+	_stopReason = _checkStopCondition();
+}
+
+void KobayashiSolver::resetState()
+{
+	_vectorInit();
+
+	_stopReason = STOP::NONE;
+	_stepCount = 0;
+}
+
+void KobayashiSolver::resetParameter()
+{
+	_parameterInit();
+}
+
+void KobayashiSolver::setThreadCount(int threadCount)
+{
+	threadCount = max(1, min(threadCount, _objectCount.y));
+	if (threadCount == _threadCount)
+		return;
+
+	_stopWorkers();
+	_threadCount = threadCount;
+	_bandStatistics.resize(_threadCount);
+	_startWorkers();
+}
+
+int KobayashiSolver::getThreadCount() const
+{
+	return _threadCount;
+}
+
+void KobayashiSolver::setStopCondition(const StopCondition& stopCondition)
+{
+	_stopCondition = stopCondition;
+}
+
+const StopCondition& KobayashiSolver::getStopCondition() const
+{
+	return _stopCondition;
+}
+
+bool KobayashiSolver::isStopped() const
+{
+	return _stopReason != STOP::NONE;
+}
+
+KobayashiSolver::STOP KobayashiSolver::getStopReason() const
+{
+	return _stopReason;
+}
+
+const char* KobayashiSolver::getStopReasonName(STOP reason)
+{
+	switch (reason)
+	{
+	case STOP::BOUNDARY:		return "boundary";
+	case STOP::SOLID_FRACTION:	return "solid_fraction";
+	case STOP::STEADY_STATE:	return "steady_state";
+	case STOP::WALL_CLOCK:		return "wall_clock";
+	default:					return "none";
+	}
+}
+
+const StepStatistics& KobayashiSolver::getStatistics() const
+{
+	return _statistics;
+}
+
+long long KobayashiSolver::getStepCount() const
+{
+	return _stepCount;
+}
+
+void KobayashiSolver::setNoise(float amplitude, unsigned long long seed)
+{
+	_noiseAmplitude = amplitude;
+	_noiseSeed = seed;
+}
+
+float KobayashiSolver::getNoiseAmplitude() const
+{
+	return _noiseAmplitude;
+}
+
+unsigned long long KobayashiSolver::getNoiseSeed() const
+{
+	return _noiseSeed;
+}
+
+float KobayashiSolver::getParameter(PARAM param)
+{
+	return _crystalParameter[static_cast<int>(param)].param_f.value;
+}
+
+void KobayashiSolver::setParameter(PARAM param, float value)
+{
+	CrystalParameter& crystalParameter = _crystalParameter[static_cast<int>(param)];
+
+	crystalParameter.param_f.value = value;
+	crystalParameter.param_i.value = static_cast<int>(round(value / crystalParameter.ratio));
+}
+
+const CrystalParameter& KobayashiSolver::getCrystalParameter(PARAM param) const
+{
+	return _crystalParameter[static_cast<int>(param)];
+}
+
+GridSize KobayashiSolver::getGridSize() const
+{
+	return _objectCount;
+}
+
+GridSize KobayashiSolver::getNucleusPosition() const
+{
+	return { _objectCount.x / 2, _objectCount.y / 2 };
+}
+
+float KobayashiSolver::getGridSpacing() const
+{
+	return _dx;
+}
+
+float KobayashiSolver::getTimeStep() const
+{
+	return _dt;
+}
+
+std::vector<float>& KobayashiSolver::getPhi()
+{
+	return _phi;
+}
+
+std::vector<float>& KobayashiSolver::getT()
+{
+	return _t;
+}
+
+void KobayashiSolver::_parameterInit()
+{
+	//
+	_tau		= 0.0003f;
+	_epsilonBar = 0.010f;		// Mean of epsilon. scaling factor that determines how much the microscopic front is magnified
+	_mu		    = 1.0f;
+	_K			= 1.6f;			// Latent heat 
+	_delta		= 0.05f;		// Strength of anisotropy (speed of growth in preferred directions)
+	_anisotropy = 6.0f;			// Degree of anisotropy
+	_alpha		= 0.9f;
+	_gamma		= 10.0f;
+	_tEq		= 1.0f;
+	//
+
+	_crystalParameter[static_cast<int>(PARAM::TAU)].param_i.value			= 3;
+	_crystalParameter[static_cast<int>(PARAM::EPLSILONBAR)].param_i.value = 10;
+	_crystalParameter[static_cast<int>(PARAM::MU)].param_i.value			= 10;
+	_crystalParameter[static_cast<int>(PARAM::K)].param_i.value			= 16;
+	_crystalParameter[static_cast<int>(PARAM::DELTA)].param_i.value		= 5;
+	_crystalParameter[static_cast<int>(PARAM::ANISOTROPY)].param_i.value  = 6;
+	_crystalParameter[static_cast<int>(PARAM::ALPHA)].param_i.value		= 9;
+	_crystalParameter[static_cast<int>(PARAM::GAMMA)].param_i.value		= 10;
+	_crystalParameter[static_cast<int>(PARAM::TEQ)].param_i.value			= 10;
+}
+
+void KobayashiSolver::_vectorInit()
+{
+	size_t vSize = static_cast<size_t>(_objectCount.x) * static_cast<size_t>(_objectCount.y);
+	_phi.assign(vSize, 0.0f);
+	_t.assign(vSize, 0.0f);
+	_gradPhiX.assign(vSize, 0.0f);
+	_gradPhiY.assign(vSize, 0.0f);
+	_lapPhi.assign(vSize, 0.0f);
+	_lapT.assign(vSize, 0.0f);
+	_angl.assign(vSize, 0.0f);
+	_epsilon.assign(vSize, 0.0f);
+	_epsilonDeriv.assign(vSize, 0.0f);
+
+
+	// Create the neuclei
+	GridSize nucleus = getNucleusPosition();
+	_createNucleus(nucleus.x, nucleus.y);
+
+	// Statistics of step 0: the five cells of the nucleus
+	_statistics = StepStatistics();
+	_statistics.solidCount = 5;
+	_statistics.solidFraction = static_cast<float>(5.0 / static_cast<double>(vSize));
+	_statistics.minX = nucleus.x - 1;
+	_statistics.minY = nucleus.y - 1;
+	_statistics.maxX = nucleus.x + 1;
+	_statistics.maxY = nucleus.y + 1;
+}
+
+void KobayashiSolver::_createNucleus(int x, int y)
+{
+	_phi[_INDEX(x, y)] = 1.0f;
+	_phi[_INDEX(x - 1, y)] = 1.0f;
+	_phi[_INDEX(x + 1, y)] = 1.0f;
+	_phi[_INDEX(x, y - 1)] = 1.0f;
+	_phi[_INDEX(x, y + 1)] = 1.0f;
+}
+
+void KobayashiSolver::_startWorkers()
+{
+	for (int band = 1; band < _threadCount; band++)
+	{
+		_workers.emplace_back(&KobayashiSolver::_worker, this, band, _poolGeneration);
+	}
+}
+
+void KobayashiSolver::_stopWorkers()
+{
+	{
+		lock_guard<mutex> lock(_poolMutex);
+		_poolExit = true;
+	}
+	_poolWake.notify_all();
+
+	for (auto& worker : _workers)
+	{
+		worker.join();
+	}
+	_workers.clear();
+	_poolExit = false;
+}
+
+void KobayashiSolver::_worker(int band, unsigned long long generation)
+{
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(_poolMutex);
+			_poolWake.wait(lock, [&] { return _poolExit || _poolGeneration != generation; });
+			if (_poolExit)
+				return;
+			generation = _poolGeneration;
+		}
+
+		_stepBand(band);
+
+		lock_guard<mutex> lock(_poolMutex);
+		if (--_poolRunning == 0)
+			_poolDone.notify_one();
+	}
+}
+
+// Each pass only writes the cells of its own rows, so the bands need no synchronization
+// except the barrier between _computeGradientLaplacian() and _evolution().
+void KobayashiSolver::_stepBand(int band)
+{
+	int jBegin = _objectCount.y * band / _threadCount;
+	int jEnd = _objectCount.y * (band + 1) / _threadCount;
+
+	_computeGradientLaplacian(band, jBegin, jEnd);
+	_barrier();
+	_evolution(band, jBegin, jEnd);
+}
+
+void KobayashiSolver::_barrier()
+{
+	unique_lock<mutex> lock(_poolMutex);
+	unsigned long long generation = _barrierGeneration;
+	if (++_barrierCount == _threadCount)
+	{
+		_barrierCount = 0;
+		_barrierGeneration++;
+		_barrierWake.notify_all();
+	}
+	else
+	{
+		_barrierWake.wait(lock, [&] { return _barrierGeneration != generation; });
+	}
+}
+
+void KobayashiSolver::_computeGradientLaplacian(int band, int jBegin, int jEnd)
+{
+
+	for (int j = jBegin; j < jEnd; j++)
+	{
+		for (int i = 0; i < _objectCount.x; i++)
+		{
+
+			int i_plus = (i + 1) % _objectCount.x;
+			int i_minus = ((i - 1) + _objectCount.x) % _objectCount.x;
+			int j_plus = (j + 1) % _objectCount.y;
+			int j_minus = ((j - 1) + _objectCount.y) % _objectCount.y;
+
+
+			_gradPhiX[_INDEX(i, j)] = (_phi[_INDEX(i_plus, j)] - _phi[_INDEX(i_minus, j)]) / _dx;
+			_gradPhiY[_INDEX(i, j)] = (_phi[_INDEX(i, j_plus)] - _phi[_INDEX(i, j_minus)]) / _dy;
+
+			_lapPhi[_INDEX(i, j)] = 
+				(2.0f * (_phi[_INDEX(i_plus, j)] + _phi[_INDEX(i_minus, j)] + _phi[_INDEX(i, j_plus)] + _phi[_INDEX(i, j_minus)])
+				+ _phi[_INDEX(i_plus, j_plus)] + _phi[_INDEX(i_minus, j_minus)] + _phi[_INDEX(i_minus, j_plus)] + _phi[_INDEX(i_plus, j_minus)]
+				- 12.0f * _phi[_INDEX(i, j)])
+				/ (3.0f * _dx * _dx);
+			_lapT[_INDEX(i, j)] = 
+				(2.0f * (_t[_INDEX(i_plus, j)] + _t[_INDEX(i_minus, j)] + _t[_INDEX(i, j_plus)] + _t[_INDEX(i, j_minus)])
+				+ _t[_INDEX(i_plus, j_plus)] + _t[_INDEX(i_minus, j_minus)] + _t[_INDEX(i_minus, j_plus)] + _t[_INDEX(i_plus, j_minus)]
+				- 12.0f * _t[_INDEX(i, j)])
+				/ (3.0f * _dx * _dx);
+
+
+			if (_gradPhiX[_INDEX(i, j)] <= +FLT_EPSILON && _gradPhiX[_INDEX(i, j)] >= -FLT_EPSILON) // _gradPhiX[i][j] == 0.0f
+				if (_gradPhiY[_INDEX(i, j)] < -FLT_EPSILON)
+					_angl[_INDEX(i, j)] = -0.5f * PI_F;
+				else if (_gradPhiY[_INDEX(i, j)] > +FLT_EPSILON)
+					_angl[_INDEX(i, j)] = 0.5f * PI_F;
+
+			if (_gradPhiX[_INDEX(i, j)] > +FLT_EPSILON)
+				if (_gradPhiY[_INDEX(i, j)] < -FLT_EPSILON)
+					_angl[_INDEX(i, j)] = 2.0f * PI_F + atan(_gradPhiY[_INDEX(i, j)] / _gradPhiX[_INDEX(i, j)]);
+				else if (_gradPhiY[_INDEX(i, j)] > +FLT_EPSILON)
+					_angl[_INDEX(i, j)] = atan(_gradPhiY[_INDEX(i, j)] / _gradPhiX[_INDEX(i, j)]);
+
+			if (_gradPhiX[_INDEX(i, j)] < -FLT_EPSILON)
+				_angl[_INDEX(i, j)] = PI_F + atan(_gradPhiY[_INDEX(i, j)] / _gradPhiX[_INDEX(i, j)]);
+
+			
+			_epsilon[_INDEX(i, j)] = _epsilonBar * (1.0f + _delta * cos(_anisotropy * _angl[_INDEX(i, j)]));
+			_epsilonDeriv[_INDEX(i, j)] = -_epsilonBar * _anisotropy * _delta * sin(_anisotropy * _angl[_INDEX(i, j)]);
+
+		}
+	}
+}
+
+void KobayashiSolver::_evolution(int band, int jBegin, int jEnd)
+{
+	StepStatistics statistics;
+	statistics.minX = _objectCount.x;
+	statistics.minY = _objectCount.y;
+
+	for (int j = jBegin; j < jEnd; j++)
+	{
+		for (int i = 0; i < _objectCount.x; i++)
+		{
+
+			int i_plus = (i + 1) % _objectCount.x;
+			int i_minus = ((i - 1) + _objectCount.x) % _objectCount.x;
+			int j_plus = (j + 1) % _objectCount.y;
+			int j_minus = ((j - 1) + _objectCount.y) % _objectCount.y;
+
+
+			float gradEpsPowX = 
+				(_epsilon[_INDEX(i_plus, j)] * _epsilon[_INDEX(i_plus, j)] 
+					- _epsilon[_INDEX(i_minus, j)] * _epsilon[_INDEX(i_minus, j)]) / _dx;
+			float gradEpsPowY = 
+				(_epsilon[_INDEX(i, j_plus)] * _epsilon[_INDEX(i, j_plus)] 
+					- _epsilon[_INDEX(i, j_minus)] * _epsilon[_INDEX(i, j_minus)]) / _dy;
+
+			float term1 = (_epsilon[_INDEX(i, j_plus)] * _epsilonDeriv[_INDEX(i, j_plus)] * _gradPhiX[_INDEX(i, j_plus)]
+				- _epsilon[_INDEX(i, j_minus)] * _epsilonDeriv[_INDEX(i, j_minus)] * _gradPhiX[_INDEX(i, j_minus)])
+				/ _dy;
+
+			float term2 = -(_epsilon[_INDEX(i_plus, j)] * _epsilonDeriv[_INDEX(i_plus, j)] * _gradPhiY[_INDEX(i_plus, j)]
+				- _epsilon[_INDEX(i_minus, j)] * _epsilonDeriv[_INDEX(i_minus, j)] * _gradPhiY[_INDEX(i_minus, j)])
+				/ _dx;
+			float term3 = gradEpsPowX * _gradPhiX[_INDEX(i, j)] + gradEpsPowY * _gradPhiY[_INDEX(i, j)];
+
+			float m = _alpha / PI_F * atan(_gamma*(_tEq - _t[_INDEX(i, j)]));
+
+			float oldPhi = _phi[_INDEX(i, j)];
+			float oldT = _t[_INDEX(i, j)];
+
+			// The random number only depends on the step and the cell, not on the band.
+			float noise = 0.0f;
+			if (_noiseAmplitude != 0.0f)
+				noise = _noiseAmplitude * oldPhi * (1.0f - oldPhi)
+					* (Philox::uniform(_noiseSeed, static_cast<uint64_t>(_stepCount), static_cast<uint64_t>(_INDEX(i, j))) - 0.5f);
+
+			_phi[_INDEX(i, j)] = _phi[_INDEX(i, j)] +
+				(term1 + term2 + _epsilon[_INDEX(i, j)] * _epsilon[_INDEX(i, j)] * _lapPhi[_INDEX(i, j)]
+					+ term3
+					+ oldPhi * (1.0f - oldPhi)*(oldPhi - 0.5f + m)
+					+ noise)*_dt / _tau;
+			_t[_INDEX(i, j)] = oldT + _lapT[_INDEX(i, j)] * _dt + _K * (_phi[_INDEX(i, j)] - oldPhi);
+
+			float deltaPhi = fabs(_phi[_INDEX(i, j)] - oldPhi);
+			statistics.maxDeltaPhi = max(statistics.maxDeltaPhi, deltaPhi);
+			if (_phi[_INDEX(i, j)] > 0.5f)
+			{
+				statistics.solidCount++;
+				statistics.minX = min(statistics.minX, i);
+				statistics.maxX = max(statistics.maxX, i);
+				statistics.minY = min(statistics.minY, j);
+				statistics.maxY = max(statistics.maxY, j);
+			}
+
+		}
+
+	}
+
+	_bandStatistics[band] = statistics;
+}
+
+void KobayashiSolver::_reduceStatistics()
+{
+	StepStatistics statistics;
+	statistics.minX = _objectCount.x;
+	statistics.minY = _objectCount.y;
+
+	for (int band = 0; band < _threadCount; band++)
+	{
+		const StepStatistics& bandStatistics = _bandStatistics[band];
+		statistics.solidCount += bandStatistics.solidCount;
+		statistics.minX = min(statistics.minX, bandStatistics.minX);
+		statistics.minY = min(statistics.minY, bandStatistics.minY);
+		statistics.maxX = max(statistics.maxX, bandStatistics.maxX);
+		statistics.maxY = max(statistics.maxY, bandStatistics.maxY);
+		statistics.maxDeltaPhi = max(statistics.maxDeltaPhi, bandStatistics.maxDeltaPhi);
+	}
+	statistics.solidFraction = static_cast<float>(
+		static_cast<double>(statistics.solidCount) / static_cast<double>(_phi.size()));
+
+	_statistics = statistics;
+}
+
+KobayashiSolver::STOP KobayashiSolver::_checkStopCondition()
+{
+	const StopCondition& condition = _stopCondition;
+	const StepStatistics& statistics = _statistics;
+
+	// The domain is periodic, so the solid starts interacting with its own images at the edge.
+	if (condition.boundaryMargin >= 0 && statistics.solidCount > 0
+		&& (statistics.minX <= condition.boundaryMargin
+			|| statistics.minY <= condition.boundaryMargin
+			|| statistics.maxX >= _objectCount.x - 1 - condition.boundaryMargin
+			|| statistics.maxY >= _objectCount.y - 1 - condition.boundaryMargin))
+		return STOP::BOUNDARY;
+
+	if (condition.solidFraction > 0.0f && statistics.solidFraction >= condition.solidFraction)
+		return STOP::SOLID_FRACTION;
+
+	if (condition.steadyDeltaPhi > 0.0f && statistics.maxDeltaPhi < condition.steadyDeltaPhi)
+		return STOP::STEADY_STATE;
+
+	if (condition.wallClockSeconds > 0.0
+		&& chrono::duration<double>(chrono::steady_clock::now() - _startTime).count() >= condition.wallClockSeconds)
+		return STOP::WALL_CLOCK;
+
+	return STOP::NONE;
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <vector>
+#include <cfloat>
+#include <cmath>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// KobayashiSolver holds the phase-field state and the numerics of the Kobayashi model.
+// It has no Win32/DirectX dependency, so it is shared by the viewer and the headless front-ends.
+
+template <typename T, typename U>
+struct ScrollParameter
+{
+	ScrollParameter(T valu, U minVa, U maxVa, U strid)
+		:value(valu), minVal(minVa), maxVal(maxVa), stride(strid) {}
+	T value;
+	U minVal;
+	U maxVal;
+	U stride;
+};
+
+struct CrystalParameter
+{
+	CrystalParameter(
+		ScrollParameter<float&, float> param_float,
+		ScrollParameter<int, int> param_int,
+		float rati)
+		:param_f(param_float), param_i(param_int), ratio(rati) {}
+
+	ScrollParameter<float&, float> param_f;
+	ScrollParameter<int, int> param_i;
+	float ratio;
+};
+
+struct GridSize
+{
+	int x;
+	int y;
+};
+
+// Reductions computed inside _evolution(), without a separate pass over the grid.
+struct StepStatistics
+{
+	long long solidCount = 0;	// Cells with phi > 0.5
+	float solidFraction = 0.0f;
+	int minX = 0;				// Bounding box of phi > 0.5. Empty if minX > maxX.
+	int minY = 0;
+	int maxX = -1;
+	int maxY = -1;
+	float maxDeltaPhi = 0.0f;	// max |phi(n+1) - phi(n)|
+};
+
+// A condition is disabled by a non-positive value (negative for boundaryMargin).
+struct StopCondition
+{
+	int boundaryMargin = -1;		// Stop when the solid comes within this many cells of the edge
+	float solidFraction = 0.0f;		// Stop when the solid fraction reaches this value
+	float steadyDeltaPhi = 0.0f;	// Stop when maxDeltaPhi falls below this value
+	double wallClockSeconds = 0.0;	// Stop this long after the first step, including the time between steps
+};
+
+
+class KobayashiSolver
+{
+public:
+	// The order matches _crystalParameter and the viewer's control IDs.
+	enum class PARAM
+	{
+		TAU, EPLSILONBAR, MU,
+		K, DELTA, ANISOTROPY,
+		ALPHA, GAMMA, TEQ,
+		COUNT
+	};
+
+	enum class STOP
+	{
+		NONE, BOUNDARY, SOLID_FRACTION, STEADY_STATE, WALL_CLOCK,
+	};
+
+	KobayashiSolver(int x, int y, float timeStep);
+	virtual ~KobayashiSolver();
+
+	// _crystalParameter refers to the members of this object.
+	KobayashiSolver(const KobayashiSolver&) = delete;
+	KobayashiSolver& operator=(const KobayashiSolver&) = delete;
+
+	// Does nothing once a stop condition has been met, until resetState().
+	void step();
+	void resetState();
+	void resetParameter();
+
+	// Rows are split into bands, one per thread. The result does not depend on the count.
+	// The threads are kept for the life of the solver and only recreated by setThreadCount().
+	void setThreadCount(int threadCount);
+	int getThreadCount() const;
+
+	void setStopCondition(const StopCondition& stopCondition);
+	const StopCondition& getStopCondition() const;
+	bool isStopped() const;
+	STOP getStopReason() const;
+	static const char* getStopReasonName(STOP reason);
+
+	// Statistics of the last step
+	const StepStatistics& getStatistics() const;
+	long long getStepCount() const;
+
+	// Interface noise a * phi * (1 - phi) * (r - 0.5) of Kobayashi's model, r uniform in [0, 1)
+	// drawn from Philox keyed on (seed, step, cell index). An amplitude of 0 disables it.
+	void setNoise(float amplitude, unsigned long long seed);
+	float getNoiseAmplitude() const;
+	unsigned long long getNoiseSeed() const;
+
+	float getParameter(PARAM param);
+	// Sets the value and keeps the scroll position in sync.
+	void setParameter(PARAM param, float value);
+	const CrystalParameter& getCrystalParameter(PARAM param) const;
+
+	GridSize getGridSize() const;
+	// _vectorInit() places the nucleus at the centre of the grid.
+	GridSize getNucleusPosition() const;
+	float getGridSpacing() const;
+	float getTimeStep() const;
+	std::vector<float>& getPhi();
+	std::vector<float>& getT();
+
+protected:
+	GridSize _objectCount = { 0, 0 };
+
+	// Cell indices are int, so a grid holds at most INT_MAX cells.
+	inline int _INDEX(int i, int j) { return (i + _objectCount.x * j); };
+
+	std::vector<CrystalParameter> _crystalParameter;
+	float _dx;
+	float _dy;
+	float _dt;
+	int _threadCount = 1;
+	float _tau;
+	float _epsilonBar;
+	float _mu;
+	float _K;
+	float _delta;
+	float _anisotropy;
+	float _alpha;
+	float _gamma;
+	float _tEq;
+	float _noiseAmplitude = 0.0f;
+	unsigned long long _noiseSeed = 0;
+
+	std::vector<float> _phi;
+	std::vector<float> _t;
+	std::vector<float> _epsilon;
+	std::vector<float> _epsilonDeriv;
+	std::vector<float> _gradPhiX;
+	std::vector<float> _gradPhiY;
+	std::vector<float> _lapPhi;
+	std::vector<float> _lapT;
+	std::vector<float> _angl;
+
+	StopCondition _stopCondition;
+	STOP _stopReason = STOP::NONE;
+	StepStatistics _statistics;
+	std::vector<StepStatistics> _bandStatistics;
+	long long _stepCount = 0;
+	std::chrono::steady_clock::time_point _startTime;	// Start of the first step
+
+	// Worker pool of step(): worker t runs band t of both passes, the calling thread runs band 0.
+	std::vector<std::thread> _workers;
+	std::mutex _poolMutex;
+	std::condition_variable _poolWake;
+	std::condition_variable _poolDone;
+	std::condition_variable _barrierWake;
+	unsigned long long _poolGeneration = 0;		// Incremented for every step handed to the workers
+	unsigned long long _barrierGeneration = 0;
+	int _poolRunning = 0;						// Workers that have not finished the current step
+	int _barrierCount = 0;
+	bool _poolExit = false;
+
+	void _parameterInit();
+	void _vectorInit();
+	void _createNucleus(int x, int y);
+	void _computeGradientLaplacian(int band, int jBegin, int jEnd);
+	void _evolution(int band, int jBegin, int jEnd);
+	void _startWorkers();
+	void _stopWorkers();
+	void _worker(int band, unsigned long long generation);
+	void _stepBand(int band);
+	void _barrier();
+	void _reduceStatistics();
+	STOP _checkStopCondition();
+};
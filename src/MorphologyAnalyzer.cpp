@@ -0,0 +1,418 @@
+#include "MorphologyAnalyzer.h"
+#include <algorithm>
+
+using namespace std;
+
+static const float PI_F = 3.14159265358979f;
+
+MorphologyAnalyzer::MorphologyAnalyzer(KobayashiSolver& solver, int interval)
+	:_solver(solver), _interval(max(1, interval))
+{
+	reset();
+}
+
+void MorphologyAnalyzer::reset()
+{
+	GridSize size = _solver.getGridSize();
+	_tileCount = { (size.x + TILE - 1) / TILE, (size.y + TILE - 1) / TILE };
+	_tileCrossing.assign(static_cast<size_t>(_tileCount.x) * static_cast<size_t>(_tileCount.y), CellWindow{ 0, 0, 0, 0 });
+	_tileWindow.assign(_tileCrossing.size(), CellWindow{ 0, 0, 0, 0 });
+	_hasTiles = false;
+	_frontTravel = 0.0f;
+	_tipDistance.clear();
+	_samples.clear();
+}
+
+bool MorphologyAnalyzer::update()
+{
+	// The final state of a run ended by a stop condition is always sampled.
+	long long step = _solver.getStepCount();
+	if ((step % _interval != 0 && !_solver.isStopped()) || (!_samples.empty() && _samples.back().step == step))
+		return false;
+
+	float dx = _solver.getGridSpacing();
+
+	MorphologySample sample;
+	sample.step = step;
+	sample.time = static_cast<float>(step) * _solver.getTimeStep();
+
+	_trackTips(sample);
+	sample.contourLength = _contourLength() * dx;
+
+	if (!_samples.empty() && sample.time > _samples.back().time)
+	{
+		const MorphologySample& last = _samples.back();
+		sample.tipVelocity = (sample.tipDistance - last.tipDistance) / (sample.time - last.time);
+	}
+
+	_samples.push_back(sample);
+	return true;
+}
+
+const MorphologySample& MorphologyAnalyzer::getSample() const
+{
+	return _samples.back();
+}
+
+const std::vector<MorphologySample>& MorphologyAnalyzer::getSamples() const
+{
+	return _samples;
+}
+
+void MorphologyAnalyzer::writeHeader(std::ostream& out)
+{
+	out << "step,time,tip_distance,tip_velocity,tip_radius,arm_count,contour_length\n";
+}
+
+void MorphologyAnalyzer::writeSample(std::ostream& out, const MorphologySample& sample)
+{
+	out << sample.step << ',' << sample.time << ','
+		<< sample.tipDistance << ',' << sample.tipVelocity << ',' << sample.tipRadius << ','
+		<< sample.armCount << ',' << sample.contourLength << '\n';
+}
+
+
+float MorphologyAnalyzer::_phiAt(int i, int j)
+{
+	GridSize size = _solver.getGridSize();
+	i = ((i % size.x) + size.x) % size.x;
+	j = ((j % size.y) + size.y) % size.y;
+	return _solver.getPhi()[i + size.x * j];
+}
+
+// Bilinear interpolation on the periodic grid
+float MorphologyAnalyzer::_phiAt(float x, float y)
+{
+	int i = static_cast<int>(floor(x));
+	int j = static_cast<int>(floor(y));
+	float fx = x - static_cast<float>(i);
+	float fy = y - static_cast<float>(j);
+
+	return (_phiAt(i, j) * (1.0f - fx) + _phiAt(i + 1, j) * fx) * (1.0f - fy)
+		+ (_phiAt(i, j + 1) * (1.0f - fx) + _phiAt(i + 1, j + 1) * fx) * fy;
+}
+
+void MorphologyAnalyzer::_trackTips(MorphologySample& sample)
+{
+	GridSize size = _solver.getGridSize();
+	GridSize nucleus = _solver.getNucleusPosition();
+	float maxRadius = 0.5f * static_cast<float>(min(size.x, size.y));
+
+	// epsilon is largest where cos(anisotropy * angl) = 1. angl is the direction of grad(phi),
+	// which points into the solid, so the arms grow along angl + PI.
+	int armCount = max(1, static_cast<int>(round(_solver.getParameter(KobayashiSolver::PARAM::ANISOTROPY))));
+	if (static_cast<int>(_tipDistance.size()) != armCount)
+		_tipDistance.assign(armCount, 0.0f);
+
+	float tipSum = 0.0f;
+	float radiusSum = 0.0f;
+	int radiusCount = 0;
+	_frontTravel = 0.0f;
+
+	for (int k = 0; k < armCount; k++)
+	{
+		float angle = 2.0f * PI_F * static_cast<float>(k) / static_cast<float>(armCount) + PI_F;
+		float dirX = cos(angle);
+		float dirY = sin(angle);
+		auto phiOnArm = [&](float r) {
+			return _phiAt(static_cast<float>(nucleus.x) + r * dirX, static_cast<float>(nucleus.y) + r * dirY);
+		};
+
+		// March one cell at a time from the previous tip, outward while in the solid
+		// and inward otherwise, then interpolate the phi = 0.5 crossing.
+		float r = _tipDistance[k];
+		float tip = 0.0f;
+		if (phiOnArm(r) > 0.5f)
+		{
+			while (r + 1.0f < maxRadius && phiOnArm(r + 1.0f) > 0.5f)
+				r += 1.0f;
+			float inner = phiOnArm(r);
+			float outer = phiOnArm(r + 1.0f);
+			tip = r + (inner - 0.5f) / max(inner - outer, FLT_EPSILON);
+		}
+		else
+		{
+			while (r >= 1.0f && phiOnArm(r - 1.0f) <= 0.5f)
+				r -= 1.0f;
+			if (r >= 1.0f)
+			{
+				float inner = phiOnArm(r - 1.0f);
+				float outer = phiOnArm(r);
+				tip = r - 1.0f + (inner - 0.5f) / max(inner - outer, FLT_EPSILON);
+			}
+		}
+		tip = min(tip, maxRadius);
+		// _tipDistance is rounded down, so this overestimates the advance by under a cell.
+		_frontTravel = max(_frontTravel, fabs(tip - _tipDistance[k]));
+		_tipDistance[k] = floor(tip);
+
+		tipSum += tip;
+
+		float radius = _fitTipRadius(dirX, dirY, tip);
+		if (radius > 0.0f)
+		{
+			radiusSum += radius;
+			radiusCount++;
+		}
+	}
+
+	float dx = _solver.getGridSpacing();
+	sample.tipDistance = tipSum / static_cast<float>(armCount) * dx;
+	sample.tipRadius = radiusCount > 0 ? radiusSum / static_cast<float>(radiusCount) * dx : 0.0f;
+	sample.armCount = _countArms(tipSum / static_cast<float>(armCount));
+}
+
+// Fits the parabola s = w^2 / (2R) to the half-widths w of the arm at s cells behind the tip.
+float MorphologyAnalyzer::_fitTipRadius(float dirX, float dirY, float tip)
+{
+	if (tip < 2.0f * FIT_DEPTH)
+		return 0.0f;
+
+	GridSize nucleus = _solver.getNucleusPosition();
+	float sw2 = 0.0f;
+	float w4 = 0.0f;
+
+	for (int s = 1; s <= FIT_DEPTH; s++)
+	{
+		float axisX = static_cast<float>(nucleus.x) + (tip - static_cast<float>(s)) * dirX;
+		float axisY = static_cast<float>(nucleus.y) + (tip - static_cast<float>(s)) * dirY;
+
+		float w = 0.0f;
+		for (int side = -1; side <= 1; side += 2)
+		{
+			float n = 0.0f;
+			float inner = _phiAt(axisX, axisY);
+			float outer = inner;
+			while (n < tip)
+			{
+				outer = _phiAt(axisX - static_cast<float>(side) * (n + 1.0f) * dirY, axisY + static_cast<float>(side) * (n + 1.0f) * dirX);
+				if (outer <= 0.5f)
+					break;
+				inner = outer;
+				n += 1.0f;
+			}
+			w += n + (inner - 0.5f) / max(inner - outer, FLT_EPSILON);
+		}
+		w *= 0.5f;
+
+		sw2 += static_cast<float>(s) * w * w;
+		w4 += w * w * w * w;
+	}
+
+	// Least squares of 1 / (2R)
+	if (sw2 <= 0.0f)
+		return 0.0f;
+	return w4 / (2.0f * sw2);
+}
+
+// Counts the primary arms from the field alone. A direction belongs to a primary arm if the
+// radial line from half the mean tip distance out to ARM_REACH of it stays solid; each run of
+// such directions at least ARM_WIDTH cells wide is one arm. Side branches cross the circle too,
+// but leave a radial line within a few cells or only graze it over a narrow run, and arms
+// still joined at their base are told apart by the liquid between them further out.
+int MorphologyAnalyzer::_countArms(float meanTip)
+{
+	float radius = 0.5f * meanTip;
+	if (radius < 3.0f)
+		return 0;
+
+	GridSize size = _solver.getGridSize();
+	GridSize nucleus = _solver.getNucleusPosition();
+	float maxRadius = 0.5f * static_cast<float>(min(size.x, size.y));
+	float reach = min(ARM_REACH * meanTip, maxRadius - 1.0f);
+	int sampleCount = static_cast<int>(4.0f * PI_F * radius);
+
+	vector<unsigned char> arm(sampleCount);
+	int gap = -1;
+	for (int n = 0; n < sampleCount; n++)
+	{
+		float angle = 2.0f * PI_F * static_cast<float>(n) / static_cast<float>(sampleCount);
+		float dirX = cos(angle);
+		float dirY = sin(angle);
+
+		float r = radius;
+		while (r <= reach && _phiAt(static_cast<float>(nucleus.x) + r * dirX, static_cast<float>(nucleus.y) + r * dirY) > 0.5f)
+			r += 1.0f;
+		arm[n] = r > reach;
+		if (!arm[n])
+			gap = n;
+	}
+	// A compact crystal has no separate arms.
+	if (gap < 0)
+		return 0;
+
+	// Walk the circle from a gap, so no run wraps around. The samples are half a cell apart.
+	int arms = 0;
+	int run = 0;
+	for (int k = 1; k <= sampleCount; k++)
+	{
+		if (arm[(gap + k) % sampleCount])
+		{
+			run++;
+			continue;
+		}
+		arms += (run >= 2 * ARM_WIDTH);
+		run = 0;
+	}
+	return arms;
+}
+
+float MorphologyAnalyzer::_contourLength()
+{
+	const StepStatistics& statistics = _solver.getStatistics();
+	if (statistics.minX > statistics.maxX)
+		return 0.0f;
+
+	GridSize size = _solver.getGridSize();
+	const CellWindow EMPTY = { 0, 0, 0, 0 };
+
+	// One cell of margin: the contour lies between a solid cell and its liquid neighbour.
+	int tileX0 = max(0, statistics.minX - 1) / TILE;
+	int tileY0 = max(0, statistics.minY - 1) / TILE;
+	int tileX1 = min(_tileCount.x - 1, (statistics.maxX + 1) / TILE);
+	int tileY1 = min(_tileCount.y - 1, (statistics.maxY + 1) / TILE);
+
+	auto tileCells = [&](int tx, int ty) {
+		return CellWindow{ tx * TILE, ty * TILE, min((tx + 1) * TILE, size.x), min((ty + 1) * TILE, size.y) };
+	};
+
+	fill(_tileWindow.begin(), _tileWindow.end(), EMPTY);
+	if (_hasTiles)
+	{
+		// The contour can only have moved as far as the front travelled since the previous
+		// sample. The tips are the fastest part of the front; the growth of the bounding box
+		// covers fronts the tip tracking does not follow. So only the cells within that
+		// distance of the previous crossings are marched.
+		float travel = max({ _frontTravel,
+			static_cast<float>(_lastStatistics.minX - statistics.minX), static_cast<float>(_lastStatistics.minY - statistics.minY),
+			static_cast<float>(statistics.maxX - _lastStatistics.maxX), static_cast<float>(statistics.maxY - _lastStatistics.maxY) });
+		int margin = static_cast<int>(ceil(travel)) + 1;
+
+		for (int ty = tileY0; ty <= tileY1; ty++)
+		{
+			for (int tx = tileX0; tx <= tileX1; tx++)
+			{
+				const CellWindow& crossing = _tileCrossing[tx + _tileCount.x * ty];
+				if (crossing.x0 >= crossing.x1)
+					continue;
+
+				CellWindow grown = {
+					max(0, crossing.x0 - margin), max(0, crossing.y0 - margin),
+					min(size.x, crossing.x1 + margin), min(size.y, crossing.y1 + margin) };
+				for (int ny = max(tileY0, grown.y0 / TILE); ny <= min(tileY1, (grown.y1 - 1) / TILE); ny++)
+				{
+					for (int nx = max(tileX0, grown.x0 / TILE); nx <= min(tileX1, (grown.x1 - 1) / TILE); nx++)
+					{
+						CellWindow cells = tileCells(nx, ny);
+						CellWindow& window = _tileWindow[nx + _tileCount.x * ny];
+						CellWindow part = {
+							max(cells.x0, grown.x0), max(cells.y0, grown.y0),
+							min(cells.x1, grown.x1), min(cells.y1, grown.y1) };
+						if (window.x0 >= window.x1)
+							window = part;
+						else
+							window = { min(window.x0, part.x0), min(window.y0, part.y0), max(window.x1, part.x1), max(window.y1, part.y1) };
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		for (int ty = tileY0; ty <= tileY1; ty++)
+		{
+			for (int tx = tileX0; tx <= tileX1; tx++)
+			{
+				_tileWindow[tx + _tileCount.x * ty] = tileCells(tx, ty);
+			}
+		}
+	}
+
+	// Cells outside the windows are pure liquid or buried in the solid and stay so.
+	fill(_tileCrossing.begin(), _tileCrossing.end(), EMPTY);
+	float length = 0.0f;
+	for (int ty = tileY0; ty <= tileY1; ty++)
+	{
+		for (int tx = tileX0; tx <= tileX1; tx++)
+		{
+			const CellWindow& window = _tileWindow[tx + _tileCount.x * ty];
+			if (window.x0 < window.x1)
+				length += _windowContourLength(window, _tileCrossing[tx + _tileCount.x * ty]);
+		}
+	}
+
+	_hasTiles = true;
+	_lastStatistics = statistics;
+	return length;
+}
+
+// Marching squares over the cells of the window (by their lower-left corner).
+// 'crossed' is set to the bounding box of the cells the contour passes through.
+float MorphologyAnalyzer::_windowContourLength(const CellWindow& window, CellWindow& crossed)
+{
+
+	auto crossing = [](float a, float b) {
+		return (0.5f - a) / (b - a);
+	};
+
+	float length = 0.0f;
+	crossed = { window.x1, window.y1, window.x0, window.y0 };
+	for (int j = window.y0; j < window.y1; j++)
+	{
+		for (int i = window.x0; i < window.x1; i++)
+		{
+			// Corners counter-clockwise from (i, j)
+			float c0 = _phiAt(i, j);
+			float c1 = _phiAt(i + 1, j);
+			float c2 = _phiAt(i + 1, j + 1);
+			float c3 = _phiAt(i, j + 1);
+
+			int code = (c0 > 0.5f) | ((c1 > 0.5f) << 1) | ((c2 > 0.5f) << 2) | ((c3 > 0.5f) << 3);
+			if (code == 0 || code == 15)
+				continue;
+			crossed = { min(crossed.x0, i), min(crossed.y0, j), max(crossed.x1, i + 1), max(crossed.y1, j + 1) };
+
+			// Crossing points on the bottom, right, top and left edges
+			float px[4], py[4];
+			bool cut[4] = {
+				(code & 1) != ((code >> 1) & 1),
+				((code >> 1) & 1) != ((code >> 2) & 1),
+				((code >> 2) & 1) != ((code >> 3) & 1),
+				((code >> 3) & 1) != (code & 1),
+			};
+			if (cut[0]) { px[0] = crossing(c0, c1);			py[0] = 0.0f; }
+			if (cut[1]) { px[1] = 1.0f;						py[1] = crossing(c1, c2); }
+			if (cut[2]) { px[2] = crossing(c3, c2);			py[2] = 1.0f; }
+			if (cut[3]) { px[3] = 0.0f;						py[3] = crossing(c0, c3); }
+
+			auto segment = [&](int a, int b) {
+				return sqrt((px[a] - px[b]) * (px[a] - px[b]) + (py[a] - py[b]) * (py[a] - py[b]));
+			};
+
+			if (code == 5 || code == 10)
+			{
+				// Saddle: the centre value decides which corners are connected.
+				bool centreSolid = (c0 + c1 + c2 + c3) * 0.25f > 0.5f;
+				if ((code == 5) == centreSolid)
+					length += segment(0, 1) + segment(2, 3);
+				else
+					length += segment(0, 3) + segment(1, 2);
+			}
+			else
+			{
+				int a = -1, b = -1;
+				for (int e = 0; e < 4; e++)
+				{
+					if (!cut[e])
+						continue;
+					if (a < 0)
+						a = e;
+					else
+						b = e;
+				}
+				length += segment(a, b);
+			}
+		}
+	}
+	return length;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <ostream>
+#include <vector>
+#include "KobayashiSolver.h"
+
+// Dendrite metrics measured in-situ, in physical units (grid spacing, time step).
+struct MorphologySample
+{
+	long long step = 0;
+	float time = 0.0f;
+	float tipDistance = 0.0f;	// Mean distance of the arm tips from the nucleus
+	float tipVelocity = 0.0f;	// d(tipDistance)/dt since the previous sample
+	float tipRadius = 0.0f;		// Mean radius of the parabola fitted to the tips
+	int armCount = 0;			// Primary arms found in the field; compare with the anisotropy
+	float contourLength = 0.0f;	// Length of the phi = 0.5 contour
+};
+
+// MorphologyAnalyzer follows a KobayashiSolver and measures the dendrite every 'interval' steps
+// and at the step where a stop condition ends the run.
+// Call update() after each step.
+//
+// The work is kept proportional to the interface rather than the grid:
+// - A tip is tracked along each preferred direction of the anisotropy, marching from the
+//   previous tip position instead of from the nucleus.
+// - The contour is extracted with marching squares only near the previous contour: each
+//   tile keeps the box of cells the contour crossed at the previous sample, and only the
+//   cells within the distance the front can have travelled since then are marched. That
+//   distance is bounded by the tip advance and the growth of the solid's bounding box
+//   (from the step reductions), so the marched band is the contour widened by the front
+//   travel of one interval. Liquid and solid away from the front are never visited.
+class MorphologyAnalyzer
+{
+public:
+	MorphologyAnalyzer(KobayashiSolver& solver, int interval);
+
+	void reset();
+	// Returns true if a sample was taken at this step.
+	bool update();
+
+	const MorphologySample& getSample() const;
+	const std::vector<MorphologySample>& getSamples() const;
+
+	static void writeHeader(std::ostream& out);
+	static void writeSample(std::ostream& out, const MorphologySample& sample);
+
+private:
+	static const int TILE = 8;
+	static const int FIT_DEPTH = 5;	// Cells behind the tip used by the tip radius fit
+	static constexpr float ARM_REACH = 0.75f;	// Fraction of the mean tip distance a primary arm reaches
+	static const int ARM_WIDTH = 3;				// Narrowest primary arm, in cells
+
+	KobayashiSolver& _solver;
+	int _interval;
+
+	GridSize _tileCount = { 0, 0 };
+	// Cells [x0, x1) x [y0, y1). Empty if x0 >= x1.
+	struct CellWindow
+	{
+		int x0, y0, x1, y1;
+	};
+
+	std::vector<CellWindow> _tileCrossing;		// Cells of each tile the contour crossed at the previous sample
+	std::vector<CellWindow> _tileWindow;		// Cells of each tile marched at this sample
+	bool _hasTiles = false;						// False until the first sample fills _tileCrossing
+	float _frontTravel = 0.0f;					// Largest tip advance since the previous sample, in cells
+	StepStatistics _lastStatistics;
+	std::vector<float> _tipDistance;	// Tip distance of each arm at the previous sample, in cells
+	std::vector<MorphologySample> _samples;
+
+	float _phiAt(float x, float y);
+	float _phiAt(int i, int j);
+
+	void _trackTips(MorphologySample& sample);
+	float _fitTipRadius(float dirX, float dirY, float tip);
+	int _countArms(float meanTip);
+	float _contourLength();
+	float _windowContourLength(const CellWindow& window, CellWindow& crossed);
+};
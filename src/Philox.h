@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+// Philox4x32-10 counter-based random numbers (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC'11).
+// Every number is a pure function of (key, counter), so there is no generator state to share
+// between threads and the stream does not depend on how the grid is split or vectorized.
+namespace Philox
+{
+	struct Counter
+	{
+		uint32_t v[4];
+	};
+
+	inline uint32_t _mulhilo(uint32_t a, uint32_t b, uint32_t& hi)
+	{
+		uint64_t product = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+		hi = static_cast<uint32_t>(product >> 32);
+		return static_cast<uint32_t>(product);
+	}
+
+	inline Counter philox4x32(Counter counter, uint32_t key0, uint32_t key1)
+	{
+		const uint32_t M0 = 0xD2511F53u;
+		const uint32_t M1 = 0xCD9E8D57u;
+		const uint32_t W0 = 0x9E3779B9u;
+		const uint32_t W1 = 0xBB67AE85u;
+
+		for (int round = 0; round < 10; round++)
+		{
+			uint32_t hi0, hi1;
+			uint32_t lo0 = _mulhilo(M0, counter.v[0], hi0);
+			uint32_t lo1 = _mulhilo(M1, counter.v[2], hi1);
+
+			counter = { { hi1 ^ counter.v[1] ^ key0, lo1, hi0 ^ counter.v[3] ^ key1, lo0 } };
+			key0 += W0;
+			key1 += W1;
+		}
+		return counter;
+	}
+
+	// Uniform in [0, 1) for a (seed, step, index) triple. The float is built from the top 24 bits,
+	// so the conversion is exact.
+	inline float uniform(uint64_t seed, uint64_t step, uint64_t index)
+	{
+		Counter counter = { {
+			static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32),
+			static_cast<uint32_t>(step), static_cast<uint32_t>(step >> 32) } };
+		Counter result = philox4x32(counter, static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32));
+		return static_cast<float>(result.v[0] >> 8) * (1.0f / 16777216.0f);
+	}
+}
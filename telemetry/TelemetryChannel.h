@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Layout of the POSIX shared-memory telemetry channel.
+//
+// [TelemetryHeader][slot 0][slot 1]...[slot slotCount-1]
+// slot = [TelemetrySlot][phi: width * height floats][t: width * height floats]
+//
+// The publisher writes frames round-robin into the slots and never waits for readers.
+// Each slot is guarded by a seqlock: 'sequence' is odd while the slot is being written.
+// A reader reads the slot in place and accepts it if 'sequence' was even and unchanged
+// across the read; otherwise it retries with the newest frame.
+namespace Telemetry
+{
+	const uint32_t MAGIC = 0x4B4F4241; // "KOBA"
+	const uint32_t VERSION = 2;
+
+	static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+		"shared-memory atomics must be lock-free");
+
+	struct FrameInfo
+	{
+		uint64_t frame;					// Index of the frame; a reader rejects a slot holding another frame
+		int64_t step;
+		float time;
+		float solidFraction;
+		int32_t minX, minY, maxX, maxY;	// Bounding box of phi > 0.5 on the full grid
+		float maxDeltaPhi;
+		int32_t stopReason;				// KobayashiSolver::STOP
+	};
+
+	struct TelemetryHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t slotCount;
+		uint32_t width;					// Downsampled frame size
+		uint32_t height;
+		uint32_t downsample;
+		uint64_t slotSize;				// Bytes per slot, including the TelemetrySlot
+		std::atomic<uint64_t> frameCount;	// Frames published so far; the newest is in slot (frameCount - 1) % slotCount
+		std::atomic<uint32_t> open;		// Cleared when the publisher goes away
+		int32_t pid;					// Publisher process, to tell a live channel from one left by a crash
+	};
+
+	struct TelemetrySlot
+	{
+		std::atomic<uint64_t> sequence;
+		FrameInfo info;
+	};
+
+	inline size_t getSlotSize(uint32_t width, uint32_t height)
+	{
+		size_t size = sizeof(TelemetrySlot) + 2 * sizeof(float) * static_cast<size_t>(width) * static_cast<size_t>(height);
+		return (size + 63) & ~static_cast<size_t>(63);
+	}
+
+	inline size_t getHeaderSize()
+	{
+		return (sizeof(TelemetryHeader) + 63) & ~static_cast<size_t>(63);
+	}
+}
@@ -0,0 +1,131 @@
+// Reference consumer of the telemetry channel: writes every frame it sees as PFM images.
+//
+// CrystalGrowthTelemetryDump [--poll-ms N] [--frames N] <channel> <output directory>
+//
+// It attaches to the channel (waiting for it to appear), polls for new frames and writes
+// phi_<frame>_<step>.pfm and t_<frame>_<step>.pfm straight from the shared memory. The frame
+// number keeps growing across the runs a batch worker publishes, while the step restarts at 0.
+// The images are written to temporary names and renamed once the frame is known to be
+// consistent; a frame overwritten during the write is discarded. It exits when the
+// publisher closes the channel.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include "TelemetryReader.h"
+
+using namespace std;
+
+// Portable float map, grayscale, little endian, bottom row first.
+static bool _writePFM(const string& path, const float* data, uint32_t width, uint32_t height)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	fprintf(file, "Pf\n%u %u\n-1.0\n", width, height);
+	size_t count = static_cast<size_t>(width) * height;
+	bool ok = fwrite(data, sizeof(float), count, file) == count;
+	return fclose(file) == 0 && ok;
+}
+
+static int _usage()
+{
+	fprintf(stderr, "usage: CrystalGrowthTelemetryDump [--poll-ms N] [--frames N] <channel> <output directory>\n");
+	return 1;
+}
+
+int main(int argc, char* argv[])
+{
+	string channel;
+	string outputDir;
+	int pollMs = 10;
+	long long maxFrames = -1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--poll-ms" && i + 1 < argc)
+			pollMs = atoi(argv[++i]);
+		else if (arg == "--frames" && i + 1 < argc)
+			maxFrames = atoll(argv[++i]);
+		else if (channel.empty())
+			channel = arg;
+		else if (outputDir.empty())
+			outputDir = arg;
+		else
+			return _usage();
+	}
+	if (channel.empty() || outputDir.empty())
+		return _usage();
+
+	TelemetryReader reader;
+	while (!reader.attach(channel))
+	{
+		this_thread::sleep_for(chrono::milliseconds(pollMs));
+	}
+
+	long long written = 0;
+	uint64_t lastFrame = 0;
+	bool hasFrame = false;
+	while (maxFrames < 0 || written < maxFrames)
+	{
+		// Check before reading, so the last frame is still dumped after the publisher closes.
+		bool open = reader.isPublisherOpen();
+
+		TelemetryFrame frame;
+		if (reader.beginRead(frame) && (!hasFrame || frame.frame != lastFrame))
+		{
+			char name[64];
+			snprintf(name, sizeof(name), "%010llu_%010lld",
+				static_cast<unsigned long long>(frame.frame), static_cast<long long>(frame.info.step));
+			string phiPath = outputDir + "/phi_" + name + ".pfm";
+			string tPath = outputDir + "/t_" + name + ".pfm";
+			string phiTmpPath = phiPath + ".tmp";
+			string tTmpPath = tPath + ".tmp";
+
+			if (!_writePFM(phiTmpPath, frame.phi, frame.width, frame.height)
+				|| !_writePFM(tTmpPath, frame.t, frame.width, frame.height))
+			{
+				fprintf(stderr, "cannot write %s\n", phiTmpPath.c_str());
+				remove(phiTmpPath.c_str());
+				remove(tTmpPath.c_str());
+				return 1;
+			}
+
+			if (reader.endRead(frame))
+			{
+				if (rename(phiTmpPath.c_str(), phiPath.c_str()) != 0
+					|| rename(tTmpPath.c_str(), tPath.c_str()) != 0)
+				{
+					fprintf(stderr, "cannot rename %s\n", phiTmpPath.c_str());
+					return 1;
+				}
+
+				printf("frame %llu step %lld time %g solid %g bbox %d %d %d %d max_dphi %g\n",
+					static_cast<unsigned long long>(frame.frame), static_cast<long long>(frame.info.step),
+					frame.info.time, frame.info.solidFraction,
+					frame.info.minX, frame.info.minY, frame.info.maxX, frame.info.maxY, frame.info.maxDeltaPhi);
+				fflush(stdout);
+
+				lastFrame = frame.frame;
+				hasFrame = true;
+				written++;
+			}
+			else
+			{
+				remove(phiTmpPath.c_str());
+				remove(tTmpPath.c_str());
+			}
+			continue;
+		}
+
+		if (!open)
+			break;
+		this_thread::sleep_for(chrono::milliseconds(pollMs));
+	}
+
+	return 0;
+}
@@ -0,0 +1,206 @@
+#include "TelemetryPublisher.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace Telemetry;
+
+// True if the channel was left behind by a publisher that closed it or no longer runs.
+// Anything else under the name, including a channel still being created, is kept.
+static bool _isStale(const string& name)
+{
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0)
+		return errno == ENOENT;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TelemetryHeader))
+	{
+		close(fd);
+		return false;
+	}
+	void* memory = mmap(nullptr, sizeof(TelemetryHeader), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED)
+		return false;
+
+	const TelemetryHeader* header = static_cast<const TelemetryHeader*>(memory);
+	bool stale = false;
+	if (header->magic == MAGIC && header->version == VERSION)
+	{
+		atomic_thread_fence(memory_order_acquire);
+		stale = header->open.load(memory_order_acquire) == 0
+			|| (kill(static_cast<pid_t>(header->pid), 0) != 0 && errno == ESRCH);
+	}
+
+	munmap(memory, sizeof(TelemetryHeader));
+	return stale;
+}
+
+TelemetryPublisher::TelemetryPublisher(const string& name, GridSize size, int downsample, int interval, int slotCount)
+	:_name(name[0] == '/' ? name : "/" + name), _size(size), _downsample(max(1, downsample)), _interval(max(1, interval))
+{
+	uint32_t width = static_cast<uint32_t>((_size.x + _downsample - 1) / _downsample);
+	uint32_t height = static_cast<uint32_t>((_size.y + _downsample - 1) / _downsample);
+	size_t slotSize = getSlotSize(width, height);
+	slotCount = max(2, slotCount);
+	_memorySize = getHeaderSize() + slotSize * static_cast<size_t>(slotCount);
+
+	// A channel left behind by a crashed publisher is replaced; attached readers keep their
+	// old mapping. A channel of a live publisher is left alone.
+	int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0 && errno == EEXIST)
+	{
+		if (!_isStale(_name))
+		{
+			fprintf(stderr, "telemetry: %s is in use by another publisher or not a telemetry channel\n", _name.c_str());
+			return;
+		}
+		shm_unlink(_name.c_str());
+		fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	}
+	if (fd < 0)
+	{
+		fprintf(stderr, "telemetry: cannot create %s\n", _name.c_str());
+		return;
+	}
+	if (ftruncate(fd, static_cast<off_t>(_memorySize)) != 0)
+	{
+		fprintf(stderr, "telemetry: cannot resize %s\n", _name.c_str());
+		close(fd);
+		shm_unlink(_name.c_str());
+		return;
+	}
+
+	void* memory = mmap(nullptr, _memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED)
+	{
+		fprintf(stderr, "telemetry: cannot map %s\n", _name.c_str());
+		shm_unlink(_name.c_str());
+		return;
+	}
+	_memory = static_cast<unsigned char*>(memory);
+
+	// ftruncate() zero-fills, so every slot starts with an even sequence and the frame count at 0.
+	TelemetryHeader* header = new (_memory) TelemetryHeader;
+	header->version = VERSION;
+	header->slotCount = static_cast<uint32_t>(slotCount);
+	header->width = width;
+	header->height = height;
+	header->downsample = static_cast<uint32_t>(_downsample);
+	header->slotSize = slotSize;
+	header->frameCount.store(0, memory_order_relaxed);
+	header->pid = static_cast<int32_t>(getpid());
+	for (int s = 0; s < slotCount; s++)
+	{
+		new (_memory + getHeaderSize() + slotSize * static_cast<size_t>(s)) TelemetrySlot;
+	}
+	header->open.store(1, memory_order_relaxed);
+
+	// Readers check the magic last, so it is published after the rest of the header.
+	atomic_thread_fence(memory_order_release);
+	header->magic = MAGIC;
+}
+
+TelemetryPublisher::~TelemetryPublisher()
+{
+	if (_memory == nullptr)
+		return;
+
+	_header()->open.store(0, memory_order_release);
+	munmap(_memory, _memorySize);
+	shm_unlink(_name.c_str());
+}
+
+bool TelemetryPublisher::isOpen() const
+{
+	return _memory != nullptr;
+}
+
+const string& TelemetryPublisher::getName() const
+{
+	return _name;
+}
+
+void TelemetryPublisher::update(KobayashiSolver& solver)
+{
+	if (solver.getStepCount() % _interval == 0 || solver.isStopped())
+		publish(solver);
+}
+
+void TelemetryPublisher::publish(KobayashiSolver& solver)
+{
+	if (_memory == nullptr)
+		return;
+
+	TelemetryHeader* header = _header();
+	uint64_t frame = header->frameCount.load(memory_order_relaxed);
+	TelemetrySlot* slot = reinterpret_cast<TelemetrySlot*>(
+		_memory + getHeaderSize() + header->slotSize * (frame % header->slotCount));
+	float* phi = reinterpret_cast<float*>(slot + 1);
+	float* t = phi + static_cast<size_t>(header->width) * header->height;
+
+	// Seqlock write: odd while the slot is inconsistent.
+	uint64_t sequence = slot->sequence.load(memory_order_relaxed);
+	slot->sequence.store(sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	const StepStatistics& statistics = solver.getStatistics();
+	slot->info.frame = frame;
+	slot->info.step = solver.getStepCount();
+	slot->info.time = static_cast<float>(solver.getStepCount()) * solver.getTimeStep();
+	slot->info.solidFraction = statistics.solidFraction;
+	slot->info.minX = statistics.minX;
+	slot->info.minY = statistics.minY;
+	slot->info.maxX = statistics.maxX;
+	slot->info.maxY = statistics.maxY;
+	slot->info.maxDeltaPhi = statistics.maxDeltaPhi;
+	slot->info.stopReason = static_cast<int32_t>(solver.getStopReason());
+	_downsampleField(solver.getPhi(), phi);
+	_downsampleField(solver.getT(), t);
+
+	slot->sequence.store(sequence + 2, memory_order_release);
+	header->frameCount.store(frame + 1, memory_order_release);
+}
+
+TelemetryHeader* TelemetryPublisher::_header()
+{
+	return reinterpret_cast<TelemetryHeader*>(_memory);
+}
+
+// Box filter over downsample x downsample blocks; blocks at the upper edges may be partial.
+void TelemetryPublisher::_downsampleField(const vector<float>& field, float* out)
+{
+	TelemetryHeader* header = _header();
+	int k = _downsample;
+
+	for (uint32_t bj = 0; bj < header->height; bj++)
+	{
+		for (uint32_t bi = 0; bi < header->width; bi++)
+		{
+			int i0 = static_cast<int>(bi) * k;
+			int j0 = static_cast<int>(bj) * k;
+			int i1 = min(i0 + k, _size.x);
+			int j1 = min(j0 + k, _size.y);
+
+			float sum = 0.0f;
+			for (int j = j0; j < j1; j++)
+			{
+				for (int i = i0; i < i1; i++)
+				{
+					sum += field[i + _size.x * j];
+				}
+			}
+			out[bi + header->width * bj] = sum / static_cast<float>((i1 - i0) * (j1 - j0));
+		}
+	}
+}
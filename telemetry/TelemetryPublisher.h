@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "KobayashiSolver.h"
+#include "TelemetryChannel.h"
+
+// Publishes downsampled phi/T frames and step statistics of a solver into a POSIX
+// shared-memory object (e.g. /dev/shm/crystalgrowth). Publishing never blocks and does
+// not depend on whether any reader is attached. The object is unlinked on destruction.
+class TelemetryPublisher
+{
+public:
+	TelemetryPublisher(const std::string& name, GridSize size, int downsample, int interval, int slotCount = 4);
+	~TelemetryPublisher();
+
+	TelemetryPublisher(const TelemetryPublisher&) = delete;
+	TelemetryPublisher& operator=(const TelemetryPublisher&) = delete;
+
+	bool isOpen() const;
+	const std::string& getName() const;
+
+	// Call after each step; publishes every 'interval' steps.
+	void update(KobayashiSolver& solver);
+	void publish(KobayashiSolver& solver);
+
+private:
+	std::string _name;
+	GridSize _size;
+	int _downsample;
+	int _interval;
+
+	unsigned char* _memory = nullptr;
+	size_t _memorySize = 0;
+
+	Telemetry::TelemetryHeader* _header();
+	void _downsampleField(const std::vector<float>& field, float* out);
+};
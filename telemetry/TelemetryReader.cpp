@@ -0,0 +1,115 @@
+#include "TelemetryReader.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace Telemetry;
+
+TelemetryReader::TelemetryReader()
+{
+}
+
+TelemetryReader::~TelemetryReader()
+{
+	detach();
+}
+
+bool TelemetryReader::attach(const string& name)
+{
+	detach();
+
+	string path = name[0] == '/' ? name : "/" + name;
+	int fd = shm_open(path.c_str(), O_RDONLY, 0);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < getHeaderSize())
+	{
+		close(fd);
+		return false;
+	}
+
+	void* memory = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED)
+		return false;
+
+	_memory = static_cast<const unsigned char*>(memory);
+	_memorySize = static_cast<size_t>(st.st_size);
+
+	// The publisher writes the magic after the rest of the header.
+	const TelemetryHeader* header = _header();
+	bool valid = header->magic == MAGIC;
+	atomic_thread_fence(memory_order_acquire);
+	valid = valid && header->version == VERSION
+		&& getHeaderSize() + header->slotSize * header->slotCount <= _memorySize;
+
+	if (!valid)
+		detach();
+	return valid;
+}
+
+void TelemetryReader::detach()
+{
+	if (_memory == nullptr)
+		return;
+
+	munmap(const_cast<unsigned char*>(_memory), _memorySize);
+	_memory = nullptr;
+	_memorySize = 0;
+}
+
+bool TelemetryReader::isAttached() const
+{
+	return _memory != nullptr;
+}
+
+bool TelemetryReader::isPublisherOpen() const
+{
+	return _memory != nullptr && _header()->open.load(memory_order_acquire) != 0;
+}
+
+uint64_t TelemetryReader::getFrameCount() const
+{
+	return _memory == nullptr ? 0 : _header()->frameCount.load(memory_order_acquire);
+}
+
+bool TelemetryReader::beginRead(TelemetryFrame& frame) const
+{
+	uint64_t frameCount = getFrameCount();
+	if (frameCount == 0)
+		return false;
+
+	const TelemetryHeader* header = _header();
+	frame.frame = frameCount - 1;
+	frame.slot = reinterpret_cast<const TelemetrySlot*>(
+		_memory + getHeaderSize() + header->slotSize * (frame.frame % header->slotCount));
+
+	frame.sequence = frame.slot->sequence.load(memory_order_acquire);
+	if (frame.sequence & 1)
+		return false;
+
+	frame.info = frame.slot->info;
+	frame.width = header->width;
+	frame.height = header->height;
+	frame.phi = reinterpret_cast<const float*>(frame.slot + 1);
+	frame.t = frame.phi + static_cast<size_t>(frame.width) * frame.height;
+	return true;
+}
+
+bool TelemetryReader::endRead(const TelemetryFrame& frame) const
+{
+	// The publisher may have wrapped around the ring between loading frameCount and the
+	// sequence, leaving a newer frame in the slot.
+	atomic_thread_fence(memory_order_acquire);
+	return frame.slot->sequence.load(memory_order_relaxed) == frame.sequence
+		&& frame.info.frame == frame.frame;
+}
+
+const TelemetryHeader* TelemetryReader::_header() const
+{
+	return reinterpret_cast<const TelemetryHeader*>(_memory);
+}
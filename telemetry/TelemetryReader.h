@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include "TelemetryChannel.h"
+
+// A frame read in place from the shared memory. The pointers are only valid until
+// TelemetryReader::endRead() confirms that the publisher did not overwrite the slot.
+struct TelemetryFrame
+{
+	uint64_t frame;
+	Telemetry::FrameInfo info;
+	uint32_t width;
+	uint32_t height;
+	const float* phi;
+	const float* t;
+	uint64_t sequence;
+	const Telemetry::TelemetrySlot* slot;
+};
+
+// Read-only view of a telemetry channel. Readers never write to the shared memory,
+// so any number of them can attach and detach while the publisher runs.
+class TelemetryReader
+{
+public:
+	TelemetryReader();
+	~TelemetryReader();
+
+	TelemetryReader(const TelemetryReader&) = delete;
+	TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+	bool attach(const std::string& name);
+	void detach();
+	bool isAttached() const;
+	// False once the publisher has closed the channel.
+	bool isPublisherOpen() const;
+
+	// Number of frames published so far.
+	uint64_t getFrameCount() const;
+
+	// Points 'frame' at the newest frame. Returns false if there is none yet or it is being written.
+	bool beginRead(TelemetryFrame& frame) const;
+	// Returns true if the frame read since beginRead() is consistent and is still frame 'frame'.
+	bool endRead(const TelemetryFrame& frame) const;
+
+private:
+	const unsigned char* _memory = nullptr;
+	size_t _memorySize = 0;
+
+	const Telemetry::TelemetryHeader* _header() const;
+};